@@ -47,7 +47,7 @@ extern "C" {
 #define OMR_GC_HEAP_CARD_TABLE
 #define OMR_GC_LARGE_OBJECT_AREA
 #define OMR_GC_MINIMUM_OBJECT_SIZE
-#undef OMR_GC_MODRON_COMPACTION
+#define OMR_GC_MODRON_COMPACTION
 #undef OMR_GC_MODRON_CONCURRENT_MARK
 #undef OMR_GC_MODRON_SCAVENGER
 #undef OMR_GC_CONCURRENT_SCAVENGER
@@ -27,7 +27,7 @@ OMR_THR_JLM_HOLD_TIMES := 1
 OMR_THR_LOCK_NURSERY := 1
 OMR_THR_TRACING := 0
 OMR_GC_DYNAMIC_CLASS_UNLOADING := 0
-OMR_GC_MODRON_COMPACTION := 0
+OMR_GC_MODRON_COMPACTION := 1
 OMR_GC_MODRON_CONCURRENT_MARK := 0
 OMR_GC_MODRON_SCAVENGER := 0
 OMR_GC_CONCURRENT_SCAVENGER := 0
@@ -28,6 +28,9 @@ THE SOFTWARE.
 
 #include "../vmobjects/VMObject.h"
 #include "../vmobjects/VMMethod.h"
+#include "../vmobjects/InlineCache.h"
+
+#include "../vm/Universe.h"
 
 
 #define EMIT1(BC) \
@@ -45,6 +48,11 @@ THE SOFTWARE.
 	mgenc->AddBytecode(CTX)
 
 
+#define CHECK_JUMP_OFFSET(OFFSET) \
+    if ((OFFSET) > 0xFFFF) \
+        _UNIVERSE->ErrorExit("Compiler: method too large for a jump")
+
+
 void BytecodeGenerator::EmitHALT( MethodGenerationContext* mgenc ) {
     EMIT1(BC_HALT);
 }
@@ -68,8 +76,9 @@ void BytecodeGenerator::EmitPUSHARGUMENT(
 
 
 void BytecodeGenerator::EmitPUSHFIELD(
-                MethodGenerationContext* mgenc, pVMSymbol field ) {
-    EMIT2(BC_PUSH_FIELD, mgenc->FindLiteralIndex((pVMObject)field));
+                MethodGenerationContext* mgenc, int idx ) {
+    // the operand is the field's slot in the receiver, resolved by the parser
+    EMIT2(BC_PUSH_FIELD, idx);
 }
 
 
@@ -92,7 +101,7 @@ void BytecodeGenerator::EmitPUSHCONSTANTString(
 
 
 void BytecodeGenerator::EmitPUSHGLOBAL(
-                MethodGenerationContext* mgenc, pVMSymbol global ) {
+                MethodGenerationContext* mgenc, pVMArray global ) {
     EMIT2(BC_PUSH_GLOBAL, mgenc->FindLiteralIndex((pVMObject)global));
 }
 
@@ -115,20 +124,25 @@ void BytecodeGenerator::EmitPOPARGUMENT(
 
 
 void BytecodeGenerator::EmitPOPFIELD(
-                MethodGenerationContext* mgenc, pVMSymbol field ) {
-    EMIT2(BC_POP_FIELD, mgenc->FindLiteralIndex((pVMObject)field));
+                MethodGenerationContext* mgenc, int idx ) {
+    EMIT2(BC_POP_FIELD, idx);
 }
 
 
 void BytecodeGenerator::EmitSEND(
                 MethodGenerationContext* mgenc, pVMSymbol msg ) {
-    EMIT2(BC_SEND, mgenc->FindLiteralIndex((pVMObject)msg));
+    // the send site index is assigned when the method is assembled
+    EMIT3(Bytecode::GetSendBytecode(msg->GetChars()),
+          mgenc->FindLiteralIndex((pVMObject)msg), NoInlineCache);
+    EMIT1(msg->GetNumberOfArguments());
 }
 
 
 void BytecodeGenerator::EmitSUPERSEND(
                 MethodGenerationContext* mgenc, pVMSymbol msg ) {
-    EMIT2(BC_SUPER_SEND, mgenc->FindLiteralIndex((pVMObject)msg));
+    EMIT3(BC_SUPER_SEND, mgenc->FindLiteralIndex((pVMObject)msg),
+          NoInlineCache);
+    EMIT1(msg->GetNumberOfArguments());
 }
 
 
@@ -142,3 +156,48 @@ void BytecodeGenerator::EmitRETURNNONLOCAL(
                 MethodGenerationContext* mgenc ) {
     EMIT1(BC_RETURN_NON_LOCAL);
 }
+
+
+// Forward jumps are emitted before their target is known: they return their
+// own index, and PatchJump makes them go to the next bytecode emitted.
+
+int BytecodeGenerator::EmitJUMP( MethodGenerationContext* mgenc ) {
+    int index = mgenc->GetNumberOfBytecodes();
+    EMIT3(BC_JUMP, 0, 0);
+    return index;
+}
+
+
+int BytecodeGenerator::EmitJUMPIFTRUE(
+                MethodGenerationContext* mgenc, pVMArray inlined ) {
+    int index = mgenc->GetNumberOfBytecodes();
+    EMIT3(BC_JUMP_IF_TRUE, 0, 0);
+    EMIT1(mgenc->FindLiteralIndex((pVMObject)inlined));
+    return index;
+}
+
+
+int BytecodeGenerator::EmitJUMPIFFALSE(
+                MethodGenerationContext* mgenc, pVMArray inlined ) {
+    int index = mgenc->GetNumberOfBytecodes();
+    EMIT3(BC_JUMP_IF_FALSE, 0, 0);
+    EMIT1(mgenc->FindLiteralIndex((pVMObject)inlined));
+    return index;
+}
+
+
+void BytecodeGenerator::EmitJUMPBACKWARD(
+                MethodGenerationContext* mgenc, int target ) {
+    int offset = mgenc->GetNumberOfBytecodes() - target;
+    CHECK_JUMP_OFFSET(offset);
+    EMIT3(BC_JUMP_BACKWARD, offset & 0xFF, offset >> 8);
+}
+
+
+void BytecodeGenerator::PatchJump(
+                MethodGenerationContext* mgenc, int jumpIndex ) {
+    int offset = mgenc->GetNumberOfBytecodes() - jumpIndex;
+    CHECK_JUMP_OFFSET(offset);
+    mgenc->SetBytecode(jumpIndex + 1, offset & 0xFF);
+    mgenc->SetBytecode(jumpIndex + 2, offset >> 8);
+}
@@ -46,20 +46,25 @@ public:
 	void EmitDUP(MethodGenerationContext* mgenc);
 	void EmitPUSHLOCAL(MethodGenerationContext* mgenc, int idx, int ctx);
 	void EmitPUSHARGUMENT(MethodGenerationContext* mgenc, int idx, int ctx);
-	void EmitPUSHFIELD(MethodGenerationContext* mgenc, pVMSymbol field);
+	void EmitPUSHFIELD(MethodGenerationContext* mgenc, int idx);
 	void EmitPUSHBLOCK(MethodGenerationContext* mgenc, pVMMethod block);
 	void EmitPUSHCONSTANT(MethodGenerationContext* mgenc, pVMObject cst);
 	void EmitPUSHCONSTANTString(
         MethodGenerationContext* mgenc, pVMString str);
-	void EmitPUSHGLOBAL(MethodGenerationContext* mgenc, pVMSymbol global);
+	void EmitPUSHGLOBAL(MethodGenerationContext* mgenc, pVMArray global);
 	void EmitPOP(MethodGenerationContext* mgenc);
 	void EmitPOPLOCAL(MethodGenerationContext* mgenc, int idx, int ctx);
 	void EmitPOPARGUMENT(MethodGenerationContext* mgenc, int idx, int ctx);
-	void EmitPOPFIELD(MethodGenerationContext* mgenc, pVMSymbol field);
+	void EmitPOPFIELD(MethodGenerationContext* mgenc, int idx);
 	void EmitSEND(MethodGenerationContext* mgenc, pVMSymbol msg);
 	void EmitSUPERSEND(MethodGenerationContext* mgenc, pVMSymbol msg);
 	void EmitRETURNLOCAL(MethodGenerationContext* mgenc);
 	void EmitRETURNNONLOCAL(MethodGenerationContext* mgenc);
+	int  EmitJUMP(MethodGenerationContext* mgenc);
+	int  EmitJUMPIFTRUE(MethodGenerationContext* mgenc, pVMArray inlined);
+	int  EmitJUMPIFFALSE(MethodGenerationContext* mgenc, pVMArray inlined);
+	void EmitJUMPBACKWARD(MethodGenerationContext* mgenc, int target);
+	void PatchJump(MethodGenerationContext* mgenc, int jumpIndex);
 };
 
 #endif
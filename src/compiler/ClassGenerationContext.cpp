@@ -35,6 +35,7 @@ ClassGenerationContext::ClassGenerationContext() :
     instanceFields(), instanceMethods(), classFields(), classMethods(){
 	name = NULL;
 	superName = NULL;
+	superClass = NULL;
     classSide = false;
 }
 
@@ -53,13 +54,34 @@ void ClassGenerationContext::AddInstanceField(pVMObject field) {
 }
 
 
-bool ClassGenerationContext::FindField(const StdString& field) {
+/**
+ * The class whose instance layout precedes the fields declared here: the
+ * superclass, or its metaclass when compiling the class side.
+ */
+pVMClass ClassGenerationContext::superLayout() {
+    if (!IsClassSide()) return superClass;
+    // a class without superclass has a metaclass inheriting from Class
+    return superClass != NULL ? superClass->GetClass() : classClass;
+}
+
 
-	ExtendedList<pVMObject> fields = IsClassSide() ?
+bool ClassGenerationContext::FindField(const StdString& field, int* index) {
+    pVMSymbol fieldName = _UNIVERSE->SymbolFor(field);
+	ExtendedList<pVMObject>& fields = IsClassSide() ?
         classFields :
         instanceFields;
-    return fields.IndexOf( (pVMObject)_UNIVERSE->SymbolFor(field)) != -1;
-
+    pVMClass layout = superLayout();
+    
+    // the index is the field's slot in the receiver, so the fields declared
+    // here come after all inherited ones
+    *index = fields.IndexOf((pVMObject)fieldName);
+    if (*index != -1) {
+        if (layout != NULL) *index += layout->GetNumberOfInstanceFields();
+        return true;
+    }
+    if (layout == NULL) return false;
+    *index = layout->LookupFieldIndex(fieldName);
+    return *index != -1;
 }
 
 
@@ -79,9 +101,6 @@ pVMClass ClassGenerationContext::Assemble() {
 //	
     // build class class name
     StdString ccname = string(name->GetStdString()) + " class";
-//    
-    // Load the super class
-    pVMClass superClass = _UNIVERSE->LoadClass(superName);
 //    
     // Allocate the class of the resulting class
     pVMClass resultClass = _UNIVERSE->NewClass(metaClassClass);
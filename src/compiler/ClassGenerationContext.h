@@ -46,7 +46,7 @@ public:
     pVMClass Assemble();
     void AssembleSystemClass(pVMClass systemClass);
 
-	bool FindField(const StdString&);
+	bool FindField(const StdString&, int* index);
 	void AddInstanceField(pVMObject);
 	void AddClassField(pVMObject);
 	void AddInstanceMethod(pVMObject);
@@ -55,6 +55,7 @@ public:
 	void SetSuperName(pVMSymbol sn) {
 //		
 		superName = sn; }
+	void SetSuperClass(pVMClass sc) { superClass = sc; }
 	void SetClassSide(bool cs) { classSide = cs; }
 	pVMSymbol GetName(void) { return name; };
 	pVMSymbol GetSuperName(void) { return superName; };
@@ -63,7 +64,10 @@ public:
 private:
     pVMSymbol name;
     pVMSymbol superName;
+    pVMClass  superClass;
     bool      classSide;
+
+    pVMClass  superLayout();
     ExtendedList<pVMObject>     instanceFields;
     ExtendedList<pVMObject>     instanceMethods;
     ExtendedList<pVMObject>     classFields;
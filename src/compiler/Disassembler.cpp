@@ -73,7 +73,7 @@ void Disassembler::dispatch(pVMObject o) {
     else if(o == _UNIVERSE->GetGlobal(_UNIVERSE->SymbolForChars("system")))
         DebugPrint("{System}");
     else {
-        pVMClass c = o->GetClass();
+        pVMClass c = CLASS_OF(o);
         if(c == stringClass) {
             DebugPrint("\"%s\"", ((pVMString)o)->GetChars());
         } else if(c == doubleClass)
@@ -81,7 +81,7 @@ void Disassembler::dispatch(pVMObject o) {
         else if(c == bigIntegerClass)
             DebugPrint("%lld", ((pVMBigInteger)o)->GetEmbeddedInteger());
         else if(c == integerClass)
-            DebugPrint("%d", ((pVMInteger)o)->GetEmbeddedInteger());
+            DebugPrint("%d", INT_VAL(o));
         else if(c == symbolClass) {
             DebugPrint("#%s", ((pVMSymbol)o)->GetChars());
         } else
@@ -89,6 +89,17 @@ void Disassembler::dispatch(pVMObject o) {
     }
 }
 
+/**
+ * Name the field a field bytecode refers to. Block methods have no holder, so
+ * this can fail and return NULL.
+ */
+pVMSymbol Disassembler::fieldName(pVMMethod method, int index) {
+    pVMClass holder = dynamic_cast<pVMClass>(method->GetHolder());
+    if (holder == NULL || index >= holder->GetNumberOfInstanceFields())
+        return NULL;
+    return holder->GetInstanceFieldName(index);
+}
+
 /**
  * Dump a class and all subsequent methods.
  */
@@ -136,11 +147,19 @@ void Disassembler::DumpMethod(pVMMethod method, const char* indent) {
     cout << endl;
 #endif
     // output bytecodes
+    uint8_t bytecode;
     for(int bc_idx = 0; 
         bc_idx < method->GetNumberOfBytecodes(); 
-        bc_idx += Bytecode::GetBytecodeLength(method->GetBytecode(bc_idx)) ) { 
+        bc_idx += Bytecode::GetBytecodeLength(bytecode) ) { 
         // the bytecode.
-        uint8_t bytecode = BC_0;
+        bytecode = BC_0;
+        // a superinstruction is followed by the intact rest of its sequence,
+        // so it is listed as its first bytecode and the others follow
+        if(Bytecode::IsSuperinstruction(bytecode)) {
+            DebugDump("%s%4d:%s\n", indent, bc_idx,
+                Bytecode::GetBytecodeName(bytecode));
+            bytecode = Bytecode::GetFirstBytecode(bytecode);
+        }
         // indent, bytecode index, bytecode mnemonic
         DebugDump("%s%4d:%s  ", indent, bc_idx,
             Bytecode::GetBytecodeName(bytecode));
@@ -149,23 +168,22 @@ void Disassembler::DumpMethod(pVMMethod method, const char* indent) {
             DebugPrint("\n");
             continue;
         }
-        switch(bytecode) {
+        // special sends have the operands of a send
+        switch(Bytecode::IsSend(bytecode) ? BC_SEND : bytecode) {
             case BC_PUSH_LOCAL:
                 DebugPrint("local: %d, context: %d\n", BC_1, BC_2); break;
             case BC_PUSH_ARGUMENT:
                 DebugPrint("argument: %d, context %d\n", BC_1, BC_2); break;
-            case BC_PUSH_FIELD:{
-                pVMObject cst = method->GetConstant(bc_idx);
+            case BC_PUSH_FIELD:
+            case BC_POP_FIELD:
+            case BC_RETURN_FIELD: {
+                pVMSymbol name = fieldName(method, BC_1);
                 
-                if (cst != NULL) {
-                    pVMSymbol name = dynamic_cast<pVMSymbol>(cst);
-                    if (name != NULL) {
-                        DebugPrint("(index: %d) field: %s\n", BC_1, 
-                                                            name->GetChars());
-                        break;
-                    }
-                } else
-                    DebugPrint("(index: %d) field: !NULL!: error!\n", BC_1);
+                if (name != NULL)
+                    DebugPrint("(index: %d) field: %s\n", BC_1, 
+                                                        name->GetChars());
+                else
+                    DebugPrint("(index: %d)\n", BC_1);
                 break;
             }
             case BC_PUSH_BLOCK: {
@@ -177,9 +195,10 @@ void Disassembler::DumpMethod(pVMMethod method, const char* indent) {
                     (pVMMethod)(method->GetConstant(bc_idx)), nindent);
                 break;
             }            
-            case BC_PUSH_CONSTANT: {
+            case BC_PUSH_CONSTANT:
+            case BC_RETURN_CONSTANT: {
                 pVMObject constant = method->GetConstant(bc_idx);
-                pVMClass cl = constant->GetClass();
+                pVMClass cl = CLASS_OF(constant);
                 pVMSymbol cname = cl->GetName();
                 
                 DebugPrint("(index: %d) value: (%s) ", 
@@ -188,10 +207,12 @@ void Disassembler::DumpMethod(pVMMethod method, const char* indent) {
                 break;
             }
             case BC_PUSH_GLOBAL: {
-                pVMObject cst = method->GetConstant(bc_idx);
+                pVMArray cst = (pVMArray)method->GetConstant(bc_idx);
                 
                 if (cst != NULL) {
-                    pVMSymbol name = dynamic_cast<pVMSymbol>(cst);
+                    //the constant is the association of the global
+                    pVMSymbol name = dynamic_cast<pVMSymbol>(
+                        cst->GetStartOfAdditionalPoint()[ASSOCIATION_KEY]);
                     if (name != NULL) {
                         DebugPrint("(index: %d) value: %s\n", BC_1, 
                                                             name->GetChars());
@@ -208,24 +229,36 @@ void Disassembler::DumpMethod(pVMMethod method, const char* indent) {
             case BC_POP_ARGUMENT:
                 DebugPrint("argument: %d, context: %d\n", BC_1, BC_2);
                 break;
-            case BC_POP_FIELD: {
+            case BC_SEND: {
                 pVMSymbol name = (pVMSymbol)(method->GetConstant(bc_idx));
                 
-                DebugPrint("(index: %d) field: %s\n", BC_1, name->GetChars());
+                DebugPrint("(index: %d, site: %d) signature: %s\n", BC_1,
+                    BC_2, name->GetChars());
                 break;
             }
-            case BC_SEND: {
+            case BC_SUPER_SEND: {
                 pVMSymbol name = (pVMSymbol)(method->GetConstant(bc_idx));
                 
-                DebugPrint("(index: %d) signature: %s\n", BC_1,
-                    name->GetChars());
+                DebugPrint("(index: %d, site: %d) signature: %s\n", BC_1,
+                    BC_2, name->GetChars());
                 break;
             }
-            case BC_SUPER_SEND: {
-                pVMSymbol name = (pVMSymbol)(method->GetConstant(bc_idx));
+            case BC_JUMP:
+                DebugPrint("(target: %d)\n", bc_idx + 
+                    Bytecode::GetJumpOffset(method->GetBytecodes() + bc_idx));
+                break;
+            case BC_JUMP_BACKWARD:
+                DebugPrint("(target: %d)\n", bc_idx - 
+                    Bytecode::GetJumpOffset(method->GetBytecodes() + bc_idx));
+                break;
+            case BC_JUMP_IF_TRUE:
+            case BC_JUMP_IF_FALSE: {
+                pVMArray inlined = (pVMArray)(method->GetConstant(bc_idx + 2));
+                pVMSymbol name = (pVMSymbol)(*inlined)[INLINED_SELECTOR];
                 
-                DebugPrint("(index: %d) signature: %s\n", BC_1,
-                    name->GetChars());
+                DebugPrint("(target: %d, index: %d) inlined: %s\n", bc_idx + 
+                    Bytecode::GetJumpOffset(method->GetBytecodes() + bc_idx),
+                    method->GetBytecode(bc_idx + 3), name->GetChars());
                 break;
             }
             default:
@@ -263,8 +296,11 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
     }
     // reset send indicator
     if(ikind != '@') ikind = '@';
+    // a superinstruction has the operands of its first bytecode
+    if(Bytecode::IsSuperinstruction(bc))
+        bc = Bytecode::GetFirstBytecode(bc);
     
-    switch(bc) {
+    switch(Bytecode::IsSend(bc) ? BC_SEND : bc) {
         case BC_HALT: {
             DebugPrint("<halting>\n\n\n");
             break;
@@ -272,7 +308,7 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
         case BC_DUP: {
             pVMObject o = frame->GetStackElement(0);
             if(o) {
-                pVMClass c = o->GetClass();
+                pVMClass c = CLASS_OF(o);
                 pVMSymbol cname = c->GetName();
                 
                 DebugPrint("<to dup: (%s) ", cname->GetChars());
@@ -286,7 +322,7 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
         case BC_PUSH_LOCAL: {
             uint8_t bc1 = BC_1, bc2 = BC_2;
             pVMObject o = frame->GetLocal(bc1, bc2);
-            pVMClass c = o->GetClass();
+            pVMClass c = CLASS_OF(o);
             pVMSymbol cname = c->GetName();
             
             DebugPrint("local: %d, context: %d <(%s) ", 
@@ -301,7 +337,7 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             pVMObject o = frame->GetArgument(bc1, bc2);
             DebugPrint("argument: %d, context: %d", bc1, bc2);
             if(dynamic_cast<pVMClass>(cl) != NULL) {
-                pVMClass c = o->GetClass();
+                pVMClass c = CLASS_OF(o);
                 pVMSymbol cname = c->GetName();
                 
                 DebugPrint("<(%s) ", cname->GetChars());
@@ -315,11 +351,11 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
         case BC_PUSH_FIELD: {
             pVMFrame ctxt = frame->GetOuterContext();
             pVMObject arg = ctxt->GetArgument(0, 0);
-            pVMSymbol name = (pVMSymbol)(method->GetConstant(bc_idx));
-            int field_index = arg->GetFieldIndex(name);
+            pVMSymbol name = CLASS_OF(arg)->GetInstanceFieldName(BC_1);
            
-            pVMObject o = arg->GetField(field_index);
-            pVMClass c = o->GetClass();
+            pVMObject o = IS_TAGGED(arg) ? (pVMObject)integerClass
+                                          : arg->GetField(BC_1);
+            pVMClass c = CLASS_OF(o);
             pVMSymbol cname = c->GetName();
             
             DebugPrint("(index: %d) field: %s <(%s) ", BC_1,
@@ -337,7 +373,7 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
         }
         case BC_PUSH_CONSTANT: {
             pVMObject constant = method->GetConstant(bc_idx);
-            pVMClass c = constant->GetClass();
+            pVMClass c = CLASS_OF(constant);
             pVMSymbol cname = c->GetName();
             
             DebugPrint("(index: %d) value: (%s) ", BC_1, 
@@ -347,13 +383,15 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             break;
         }
         case BC_PUSH_GLOBAL: {
-            pVMSymbol name = (pVMSymbol)(method->GetConstant(bc_idx));
-            pVMObject o = _UNIVERSE->GetGlobal(name);
+            pVMObject* association = ((pVMArray)method->GetConstant(bc_idx))
+                                                ->GetStartOfAdditionalPoint();
+            pVMSymbol name = (pVMSymbol)association[ASSOCIATION_KEY];
+            pVMObject o = association[ASSOCIATION_VALUE];
             pVMSymbol cname;
             
             char*   c_cname;
             if(o) {
-                pVMClass c = o->GetClass();
+                pVMClass c = CLASS_OF(o);
                 cname = c->GetName();
                 
                 c_cname = cname->GetChars();
@@ -367,9 +405,9 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             break;
         }
         case BC_POP: {
-            size_t sp = frame->GetStackPointer()->GetEmbeddedInteger();
+            size_t sp = frame->GetStackPointer();
             pVMObject o = (*(pVMArray)frame)[sp];
-            pVMClass c = o->GetClass();
+            pVMClass c = CLASS_OF(o);
             pVMSymbol cname = c->GetName();
             
             DebugPrint("popped <(%s) ", cname->GetChars());
@@ -379,9 +417,9 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             break;            
         }            
         case BC_POP_LOCAL: {
-            size_t sp = frame->GetStackPointer()->GetEmbeddedInteger();
+            size_t sp = frame->GetStackPointer();
             pVMObject o = (*(pVMArray)frame)[sp];
-            pVMClass c = o->GetClass();
+            pVMClass c = CLASS_OF(o);
             pVMSymbol cname = c->GetName();
             
             DebugPrint("popped local: %d, context: %d <(%s) ", BC_1, BC_2,
@@ -392,9 +430,9 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             break;            
         }
         case BC_POP_ARGUMENT: {
-            size_t sp = frame->GetStackPointer()->GetEmbeddedInteger();
+            size_t sp = frame->GetStackPointer();
             pVMObject o = (*(pVMArray)frame)[sp];
-            pVMClass c = o->GetClass();
+            pVMClass c = CLASS_OF(o);
             pVMSymbol cname = c->GetName();
             DebugPrint("argument: %d, context: %d <(%s) ", BC_1, BC_2,
                         cname->GetChars());
@@ -404,10 +442,12 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             break;
         }
         case BC_POP_FIELD: {
-            size_t sp = frame->GetStackPointer()->GetEmbeddedInteger();
+            size_t sp = frame->GetStackPointer();
             pVMObject o = (*(pVMArray)frame)[sp];
-            pVMSymbol name = (pVMSymbol)(method->GetConstant(bc_idx));
-            pVMClass c = o->GetClass();
+            pVMFrame ctxt = frame->GetOuterContext();
+            pVMSymbol name = CLASS_OF(ctxt->GetArgument(0, 0))
+                                ->GetInstanceFieldName(BC_1);
+            pVMClass c = CLASS_OF(o);
             pVMSymbol cname = c->GetName();
             
             DebugPrint("(index: %d) field: %s <(%s) ",  BC_1,
@@ -427,11 +467,14 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
             pVMObject elem = _UNIVERSE->GetInterpreter()->GetFrame()->
                                    GetStackElement(
                                        Signature::GetNumberOfArguments(sel)-1);
-            pVMClass elemClass = elem->GetClass();
+            pVMClass elemClass = CLASS_OF(elem);
             pVMInvokable inv =  dynamic_cast<pVMInvokable>(
                                             elemClass->LookupInvokable(sel));
             
-            if(inv != NULL && inv->IsPrimitive()) 
+            //trivial methods don't get a frame either
+            pVMMethod meth = dynamic_cast<pVMMethod>(inv);
+            if(inv != NULL && (inv->IsPrimitive() ||
+               (meth != NULL && meth->GetTrivialKind() != TrivialNone))) 
                 DebugPrint("*)\n");
             else {
                 DebugPrint("\n");    
@@ -440,11 +483,38 @@ void Disassembler::DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx) {
                 break;
         }            
         case BC_RETURN_LOCAL:
-        case BC_RETURN_NON_LOCAL: {
+        case BC_RETURN_NON_LOCAL:
+        case BC_RETURN_SELF:
+        case BC_RETURN_FIELD:
+        case BC_RETURN_CONSTANT: {
             DebugPrint(")\n");
             indentc--; ikind='<'; //visual
             break;
         }
+        case BC_JUMP: {
+            DebugPrint("(target: %d)\n", bc_idx + 
+                    Bytecode::GetJumpOffset(method->GetBytecodes() + bc_idx));
+            break;
+        }
+        case BC_JUMP_BACKWARD: {
+            DebugPrint("(target: %d)\n", bc_idx - 
+                    Bytecode::GetJumpOffset(method->GetBytecodes() + bc_idx));
+            break;
+        }
+        case BC_JUMP_IF_TRUE:
+        case BC_JUMP_IF_FALSE: {
+            pVMObject o = frame->GetStackElement(0);
+            pVMClass c = CLASS_OF(o);
+            pVMSymbol cname = c->GetName();
+            
+            DebugPrint("(target: %d) <(%s) ", bc_idx + 
+                    Bytecode::GetJumpOffset(method->GetBytecodes() + bc_idx),
+                    cname->GetChars());
+            //dispatch
+            dispatch(o);
+            DebugPrint(">\n");
+            break;
+        }
         default:
             DebugPrint("<incorrect bytecode>\n");
             break;
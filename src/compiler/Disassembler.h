@@ -40,6 +40,7 @@ public:
     static void DumpBytecode(pVMFrame frame, pVMMethod method, int bc_idx);
 private:
     static void dispatch(pVMObject o);
+    static pVMSymbol fieldName(pVMMethod method, int index);
 };
 
 #endif
@@ -26,13 +26,19 @@ THE SOFTWARE.
 
 #include "MethodGenerationContext.h"
 
+#include <algorithm>
+
 #include "../interpreter/bytecodes.h"
 
 #include "../vmobjects/VMSymbol.h"
+#include "../vmobjects/VMArray.h"
 #include "../vmobjects/VMMethod.h"
 #include "../vmobjects/Signature.h"
 #include "../vmobjects/VMMethod.h"
 #include "../vmobjects/VMPrimitive.h"
+#include "../vmobjects/InlineCache.h"
+
+static void emitSuperinstructions(std::vector<uint8_t>& bytecode);
 
 MethodGenerationContext::MethodGenerationContext() {
 	//signature = 0;
@@ -45,14 +51,18 @@ MethodGenerationContext::MethodGenerationContext() {
 	primitive = false;
 	blockMethod = false;
 	finished = false;
+	outerContextAccessed = false;
 }
 
 pVMMethod MethodGenerationContext::Assemble() {
+    if (optimizeBytecodes) this->optimize();
+
     // create a method instance with the given number of bytecodes and literals
     int numLiterals = this->literals.Size();
+    int numSendSites = this->NumberSendSites();
     
     pVMMethod meth = _UNIVERSE->NewMethod(this->signature, bytecode.size(),
-                                                                numLiterals);
+                                          numLiterals, numSendSites);
     
     // populate the fields that are immediately available
     int numLocals = this->locals.Size();
@@ -60,6 +70,9 @@ pVMMethod MethodGenerationContext::Assemble() {
 
     meth->SetMaximumNumberOfStackElements(this->ComputeStackDepth());
 
+    this->classifyTrivial(meth);
+    emitSuperinstructions(bytecode);
+
     // copy literals into the method
     for(int i = 0; i < numLiterals; i++) {
         pVMObject l = literals.Get(i);
@@ -103,21 +116,249 @@ bool MethodGenerationContext::FindVar(const StdString& var, int* index,
     return true;
 }
 
-bool MethodGenerationContext::FindField(const StdString& field) {
-	return holderGenc->FindField(field);
+bool MethodGenerationContext::FindField(const StdString& field, int* index) {
+	return holderGenc->FindField(field, index);
 }
 
 int MethodGenerationContext::GetNumberOfArguments() { 
     return arguments.Size(); 
 }
 
+void MethodGenerationContext::AccessOuterContext(int context) {
+    // the blocks between the access and the variable's context can't do
+    // without their outer contexts
+    MethodGenerationContext* genc = this;
+    while (context-- > 0) {
+        genc->outerContextAccessed = true;
+        genc = genc->outerGenc;
+    }
+}
+
+void MethodGenerationContext::AccessHomeContext() {
+    // fields and non-local returns need the method the blocks are nested in
+    for (MethodGenerationContext* genc = this; genc->blockMethod;
+         genc = genc->outerGenc)
+        genc->outerContextAccessed = true;
+}
+
+int MethodGenerationContext::AddInlinedVariables(
+                                        MethodGenerationContext* block) {
+    // the arguments and locals of a block inlined into this method become
+    // locals of it, which are out of scope by their names
+    int firstLocal = locals.Size();
+    for (int i = 1; i < block->arguments.Size(); ++i)
+        locals.PushBack("$" + block->arguments.Get(i));
+    for (int i = 0; i < block->locals.Size(); ++i)
+        locals.PushBack("$" + block->locals.Get(i));
+    return firstLocal;
+}
+
+
+static bool isVariableAccess(uint8_t bc) {
+    return bc == BC_PUSH_LOCAL || bc == BC_PUSH_ARGUMENT ||
+           bc == BC_POP_LOCAL || bc == BC_POP_ARGUMENT;
+}
+
+
+// Adapts an access to a variable from code nested depth levels deep in an
+// inlined block. The block's arguments and locals are locals of the method
+// from firstLocal on, and the contexts beyond the block are one level closer.
+// Answers whether the access changed.
+static bool adaptVariableAccess(uint8_t* bc, int depth, int firstLocal,
+                                int numberOfArguments) {
+    if (bc[2] < depth) return false;
+    if (bc[2] > depth) {
+        bc[2]--;
+        return true;
+    }
+    // argument 0 is the block itself, which doesn't exist anymore
+    if (bc[0] == BC_PUSH_ARGUMENT || bc[0] == BC_POP_ARGUMENT)
+        bc[1] = firstLocal + bc[1] - 1;
+    else
+        bc[1] = firstLocal + numberOfArguments - 1 + bc[1];
+    bc[0] = bc[0] == BC_PUSH_ARGUMENT || bc[0] == BC_PUSH_LOCAL ? BC_PUSH_LOCAL
+                                                                : BC_POP_LOCAL;
+    return true;
+}
+
+
+static pVMMethod adaptNestedBlock(pVMMethod method, int depth, int firstLocal,
+                                  int numberOfArguments);
+
+
+// Adapts the descriptor of a message inlined into code nested depth levels
+// deep in an inlined block, whose code starts shift bytecodes further on. The
+// block's own descriptors are always copied, as the block assembled on its
+// own keeps the originals.
+static pVMArray adaptDescriptor(pVMArray inlined, int depth, int shift,
+                                int firstLocal, int numberOfArguments) {
+    int size = inlined->GetNumberOfIndexableFields();
+    std::vector<pVMObject> parts(size);
+    bool changed = depth == 0;
+    for (int i = INLINED_RECEIVER; i < size; ++i) {
+        pVMObject part = (*inlined)[i];
+        if (part == nilObject)
+            parts[i] = part;
+        else if (CLASS_OF(part) == integerClass)
+            // a local of the code the descriptor belongs to
+            parts[i] = depth > 0 ? part : (pVMObject)_UNIVERSE->NewInteger(
+                firstLocal + numberOfArguments - 1 + INT_VAL(part));
+        else
+            parts[i] = (pVMObject)adaptNestedBlock((pVMMethod)part, depth + 1,
+                                                   firstLocal,
+                                                   numberOfArguments);
+        changed = changed || parts[i] != part;
+    }
+    if (!changed) return inlined;
+
+    pVMArray copy = _UNIVERSE->NewArray(size);
+    copy->SetIndexableField(INLINED_SELECTOR, (*inlined)[INLINED_SELECTOR]);
+    copy->SetIndexableField(INLINED_RESUME, (pVMObject)_UNIVERSE->NewInteger(
+        INT_VAL((*inlined)[INLINED_RESUME]) + shift));
+    for (int i = INLINED_RECEIVER; i < size; ++i)
+        copy->SetIndexableField(i, parts[i]);
+    return copy;
+}
+
+
+// A block nested depth levels deep in an inlined block stays a block, but
+// one whose accesses to the inlined block's variables and beyond are adapted.
+// It is copied if that changes anything.
+static pVMMethod adaptNestedBlock(pVMMethod method, int depth, int firstLocal,
+                                  int numberOfArguments) {
+    int length = method->GetNumberOfBytecodes();
+    std::vector<uint8_t> code(method->GetBytecodes(),
+                              method->GetBytecodes() + length);
+    int numLiterals = method->GetNumberOfIndexableFields();
+    std::vector<pVMObject> literals(numLiterals);
+    for (int i = 0; i < numLiterals; ++i)
+        literals[i] = method->GetLiteral(i);
+
+    bool changed = false;
+    for (int i = 0; i < length; i += Bytecode::GetBytecodeLength(code[i])) {
+        // the changed code gets its superinstructions afresh
+        if (Bytecode::IsSuperinstruction(code[i]))
+            code[i] = Bytecode::GetFirstBytecode(code[i]);
+
+        if (isVariableAccess(code[i]))
+            changed |= adaptVariableAccess(&code[i], depth, firstLocal,
+                                           numberOfArguments);
+        else if (code[i] == BC_PUSH_BLOCK)
+            literals[code[i + 1]] = (pVMObject)adaptNestedBlock(
+                (pVMMethod)literals[code[i + 1]], depth + 1, firstLocal,
+                numberOfArguments);
+        else if (code[i] == BC_JUMP_IF_TRUE || code[i] == BC_JUMP_IF_FALSE)
+            literals[code[i + 3]] = (pVMObject)adaptDescriptor(
+                (pVMArray)literals[code[i + 3]], depth, 0, firstLocal,
+                numberOfArguments);
+    }
+    for (int i = 0; i < numLiterals; ++i)
+        changed = changed || literals[i] != method->GetLiteral(i);
+    if (!changed) return method;
+
+    emitSuperinstructions(code);
+    pVMMethod copy = _UNIVERSE->NewMethod(method->GetSignature(), length,
+                                          numLiterals,
+                                          method->GetNumberOfSendSites());
+    copy->SetNumberOfLocals(method->GetNumberOfLocals());
+    copy->SetMaximumNumberOfStackElements(
+        method->GetMaximumNumberOfStackElements());
+    for (int i = 0; i < numLiterals; ++i)
+        copy->SetIndexableField(i, literals[i]);
+    for (int i = 0; i < length; ++i)
+        copy->SetBytecode(i, code[i]);
+    return copy;
+}
+
+
+void MethodGenerationContext::InlineCode(MethodGenerationContext* block,
+                                         int firstLocal) {
+    // the code of a block inlined into this method, which leaves the block's
+    // value on the stack. Its variables have been added from firstLocal on.
+    int numberOfArguments = block->arguments.Size();
+    int shift = bytecode.size();
+    const std::vector<uint8_t>& code = block->bytecode;
+    size_t i = 0;
+    while (i < code.size()) {
+        uint8_t bc = code[i];
+        size_t next = i + Bytecode::GetBytecodeLength(bc);
+        // the return at the end answers the value of the last expression
+        if (bc == BC_RETURN_LOCAL && next == code.size()) break;
+
+        size_t index = bytecode.size();
+        bytecode.insert(bytecode.end(), code.begin() + i, code.begin() + next);
+        if (isVariableAccess(bc))
+            adaptVariableAccess(&bytecode[index], 0, firstLocal,
+                                numberOfArguments);
+        else if (bc == BC_PUSH_BLOCK) {
+            pVMMethod nested = adaptNestedBlock(
+                (pVMMethod)block->literals.Get(code[i + 1]), 1, firstLocal,
+                numberOfArguments);
+            AddLiteralIfAbsent((pVMObject)nested);
+            bytecode[index + 1] = FindLiteralIndex((pVMObject)nested);
+        } else if (bc == BC_PUSH_CONSTANT || bc == BC_PUSH_GLOBAL ||
+                   Bytecode::IsSend(bc) || bc == BC_SUPER_SEND) {
+            pVMObject literal = block->literals.Get(code[i + 1]);
+            AddLiteralIfAbsent(literal);
+            bytecode[index + 1] = FindLiteralIndex(literal);
+        } else if (bc == BC_JUMP_IF_TRUE || bc == BC_JUMP_IF_FALSE) {
+            AddLiteral((pVMObject)adaptDescriptor(
+                (pVMArray)block->literals.Get(code[i + 3]), 0, shift,
+                firstLocal, numberOfArguments));
+            bytecode[index + 3] = literals.Size() - 1;
+        } else if (bc == BC_RETURN_NON_LOCAL && !blockMethod)
+            // in a method, a return from the block is a local one
+            bytecode[index] = BC_RETURN_LOCAL;
+        i = next;
+    }
+}
+
+
+// whether the code of method, nested depth levels deep, or blocks in it
+// refer to the variables of the context at that depth
+static bool refersToContext(pVMMethod method, int depth) {
+    int length = method->GetNumberOfBytecodes();
+    for (int i = 0; i < length; ) {
+        uint8_t bc = method->GetBytecode(i);
+        if (Bytecode::IsSuperinstruction(bc))
+            bc = Bytecode::GetFirstBytecode(bc);
+        if (isVariableAccess(bc) && method->GetBytecode(i + 2) == depth)
+            return true;
+        if (bc == BC_PUSH_BLOCK &&
+            refersToContext((pVMMethod)method->GetConstant(i), depth + 1))
+            return true;
+        i += Bytecode::GetBytecodeLength(bc);
+    }
+    return false;
+}
+
+
+bool MethodGenerationContext::IsCaptured() {
+    // whether blocks in the code refer to its arguments and locals. Those are
+    // fresh in every evaluation of a block, so an inlined loop can't share
+    // them between its iterations.
+    for (size_t i = 0; i < bytecode.size();
+         i += Bytecode::GetBytecodeLength(bytecode[i]))
+        if (bytecode[i] == BC_PUSH_BLOCK &&
+            refersToContext((pVMMethod)literals.Get(bytecode[i + 1]), 1))
+            return true;
+    return false;
+}
+
 uint8_t MethodGenerationContext::ComputeStackDepth() {
 	uint8_t depth = 0;
     uint8_t maxDepth = 0;
     unsigned int i = 0;
+    // the depth where the code inlined in place of a message ends, with the
+    // result of that message sent after all
+    std::vector<uint8_t> resumeDepth(bytecode.size() + 1, 0);
     
     while(i < bytecode.size()) {
-        switch(bytecode[i]) {
+        if(resumeDepth[i] > depth)
+            depth = resumeDepth[i];
+        // special sends count like any other send
+        uint8_t bc = Bytecode::IsSend(bytecode[i]) ? BC_SEND : bytecode[i];
+        switch(bc) {
             case BC_HALT             :          i++;    break;
             case BC_DUP              : depth++; i++;    break;
             case BC_PUSH_LOCAL       :
@@ -133,17 +374,39 @@ uint8_t MethodGenerationContext::ComputeStackDepth() {
             case BC_SEND             :
             case BC_SUPER_SEND       : {
                 // these are special: they need to look at the number of
-                // arguments (extractable from the signature)
-                pVMSymbol sig = (pVMSymbol)literals.Get(bytecode[i + 1]);
-                
-                depth -= Signature::GetNumberOfArguments(sig);
+                // arguments (the last operand)
+                depth -= bytecode[i + 3];
                 
 				depth++; // return value
-                i += 2;
+                i += 4;
                 break;
             }
             case BC_RETURN_LOCAL     :
-            case BC_RETURN_NON_LOCAL :          i++;    break;
+            case BC_RETURN_NON_LOCAL :
+            case BC_RETURN_SELF      :          i++;    break;
+            case BC_RETURN_FIELD     :
+            case BC_RETURN_CONSTANT  :          i += 2; break;
+            // the bytecodes are counted in order, so both branches of an
+            // inlined conditional count towards the depth; that is more than
+            // needed, but never less
+            case BC_JUMP             :
+            case BC_JUMP_BACKWARD    :          i += 3; break;
+            case BC_JUMP_IF_TRUE     :
+            case BC_JUMP_IF_FALSE    : {
+                // sending the inlined message pushes its receiver and
+                // arguments in place of the condition
+                pVMArray inlined = (pVMArray)literals.Get(bytecode[i + 3]);
+                int parts = inlined->GetNumberOfIndexableFields() -
+                            INLINED_RECEIVER;
+                if(depth - 1 + parts > maxDepth)
+                    maxDepth = depth - 1 + parts;
+                int resume = INT_VAL((*inlined)[INLINED_RESUME]);
+                if(depth > resumeDepth[resume])
+                    resumeDepth[resume] = depth;
+                depth--;
+                i += 4;
+                break;
+            }
             default                  :
                 cout << "Illegal bytecode: " << bytecode[i];
                 _UNIVERSE->Quit(1);
@@ -157,6 +420,243 @@ uint8_t MethodGenerationContext::ComputeStackDepth() {
 }
 
 
+void MethodGenerationContext::classifyTrivial(pVMMethod meth) {
+    // a method that only answers self, a literal or a field, or only stores
+    // its argument in a field, is run by a send without a frame. Its code is
+    // that of the parser or, with -O, of the optimizer.
+    if (blockMethod) return;
+    const std::vector<uint8_t>& bc = bytecode;
+    size_t length = bc.size();
+    bool returnsSelf = length >= 4 && bc[length - 4] == BC_PUSH_ARGUMENT &&
+                       bc[length - 3] == 0 && bc[length - 2] == 0 &&
+                       bc[length - 1] == BC_RETURN_LOCAL;
+    bool returnsSelfOptimized = length >= 1 &&
+                                bc[length - 1] == BC_RETURN_SELF;
+
+    if ((returnsSelf && length == 4) || (returnsSelfOptimized && length == 1))
+        meth->SetTrivial(TrivialSelf, 0);
+    else if ((length == 3 && bc[0] == BC_PUSH_CONSTANT &&
+              bc[2] == BC_RETURN_LOCAL) ||
+             (length == 2 && bc[0] == BC_RETURN_CONSTANT))
+        meth->SetTrivial(TrivialConstant, bc[1]);
+    else if ((length == 3 && bc[0] == BC_PUSH_FIELD &&
+              bc[2] == BC_RETURN_LOCAL) ||
+             (length == 2 && bc[0] == BC_RETURN_FIELD))
+        meth->SetTrivial(TrivialGetter, bc[1]);
+    else if (meth->GetNumberOfArguments() == 2 && bc[0] == BC_PUSH_ARGUMENT &&
+             bc[1] == 1 && bc[2] == 0) {
+        // PUSH_ARGUMENT 1 0, DUP, POP_FIELD, POP, ^self
+        if (returnsSelf && length == 11 && bc[3] == BC_DUP &&
+            bc[4] == BC_POP_FIELD && bc[6] == BC_POP)
+            meth->SetTrivial(TrivialSetter, bc[5]);
+        // PUSH_ARGUMENT 1 0, POP_FIELD, RETURN_SELF
+        else if (returnsSelfOptimized && length == 6 && bc[3] == BC_POP_FIELD)
+            meth->SetTrivial(TrivialSetter, bc[4]);
+    }
+}
+
+
+static void emitSuperinstructions(std::vector<uint8_t>& bytecode) {
+    // peephole pass replacing the first bytecode of every pair that has a
+    // superinstruction; the pairs don't overlap
+    size_t i = 0;
+    while (i < bytecode.size()) {
+        size_t next = i + Bytecode::GetBytecodeLength(bytecode[i]);
+        if (next >= bytecode.size()) break;
+
+        uint8_t super = Bytecode::GetSuperinstruction(bytecode[i],
+                                                      bytecode[next]);
+        if (super != BC_HALT) {
+            bytecode[i] = super;
+            next += Bytecode::GetBytecodeLength(bytecode[next]);
+        }
+        i = next;
+    }
+}
+
+
+// the index a jump at index goes to, or -1 for any other bytecode
+static int jumpTarget(const std::vector<uint8_t>& bytecode, size_t index) {
+    switch (bytecode[index]) {
+        case BC_JUMP:
+        case BC_JUMP_IF_TRUE:
+        case BC_JUMP_IF_FALSE:
+            return index + Bytecode::GetJumpOffset(&bytecode[index]);
+        case BC_JUMP_BACKWARD:
+            return index - Bytecode::GetJumpOffset(&bytecode[index]);
+        default:
+            return -1;
+    }
+}
+
+
+static bool isPushVariable(uint8_t bc) {
+    return bc == BC_PUSH_LOCAL || bc == BC_PUSH_ARGUMENT ||
+           bc == BC_PUSH_FIELD;
+}
+
+
+static bool isPopVariable(uint8_t bc) {
+    return bc == BC_POP_LOCAL || bc == BC_POP_ARGUMENT || bc == BC_POP_FIELD;
+}
+
+
+static bool endsBasicBlock(uint8_t bc) {
+    switch (bc) {
+        case BC_RETURN_LOCAL:
+        case BC_RETURN_NON_LOCAL:
+        case BC_RETURN_SELF:
+        case BC_RETURN_FIELD:
+        case BC_RETURN_CONSTANT:
+        case BC_JUMP:
+        case BC_JUMP_BACKWARD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+void MethodGenerationContext::optimize() {
+    // one rewrite can make way for another, e.g. a ^self after a POP
+    while (this->optimizePass())
+        ;
+}
+
+
+bool MethodGenerationContext::optimizePass() {
+    // peephole pass over the bytecodes, rewriting sequences that don't span
+    // the start of a basic block and removing the code after a return or
+    // jump that no jump leads to
+    size_t size = bytecode.size();
+
+    // the conditional jumps of inlined messages also lead to the bytecode the
+    // result of the message continues at if it is sent after all
+    std::vector<bool> isTarget(size + 1, false);
+    for (size_t i = 0; i < size; i += Bytecode::GetBytecodeLength(bytecode[i])) {
+        int target = jumpTarget(bytecode, i);
+        if (target != -1) isTarget[target] = true;
+        if (bytecode[i] == BC_JUMP_IF_TRUE || bytecode[i] == BC_JUMP_IF_FALSE) {
+            pVMArray inlined = (pVMArray)literals.Get(bytecode[i + 3]);
+            isTarget[INT_VAL((*inlined)[INLINED_RESUME])] = true;
+        }
+    }
+
+    std::vector<uint8_t> optimized;
+    std::vector<int> newIndex(size + 1);
+    // the new index of every jump, with the old index of its target
+    std::vector< std::pair<size_t, int> > jumps;
+    bool changed = false;
+    bool reachable = true;
+    size_t i = 0;
+    while (i < size) {
+        newIndex[i] = optimized.size();
+        uint8_t bc = bytecode[i];
+        size_t next = i + Bytecode::GetBytecodeLength(bc);
+        if (isTarget[i]) reachable = true;
+        if (!reachable) {
+            changed = true;
+            i = next;
+            continue;
+        }
+
+        // the bytecodes following in the same basic block, BC_HALT if there
+        // are none
+        uint8_t bc2 = next < size && !isTarget[next] ? bytecode[next] : BC_HALT;
+        size_t next2 = bc2 != BC_HALT ? next + Bytecode::GetBytecodeLength(bc2)
+                                      : size;
+        uint8_t bc3 = next2 < size && !isTarget[next2] ? bytecode[next2]
+                                                        : BC_HALT;
+
+        if (bc == BC_DUP && isPopVariable(bc2) && bc3 == BC_POP) {
+            // an assignment whose value isn't used just stores it
+            optimized.insert(optimized.end(), bytecode.begin() + next,
+                             bytecode.begin() + next2);
+            i = next2 + 1;
+        } else if ((bc == BC_DUP || isPushVariable(bc) ||
+                    bc == BC_PUSH_CONSTANT) && bc2 == BC_POP) {
+            // a value pushed only to be popped again
+            i = next + 1;
+        } else if (isPushVariable(bc) && isPopVariable(bc2) &&
+                   bc2 - BC_POP_LOCAL == bc - BC_PUSH_LOCAL &&
+                   std::equal(bytecode.begin() + i + 1, bytecode.begin() + next,
+                              bytecode.begin() + next + 1)) {
+            // a variable stored back into itself
+            i = next2;
+        } else if (bc2 == BC_RETURN_LOCAL && bc == BC_PUSH_ARGUMENT &&
+                   bytecode[i + 1] == 0 && bytecode[i + 2] == 0) {
+            optimized.push_back(BC_RETURN_SELF);
+            reachable = false;
+            i = next2;
+        } else if (bc2 == BC_RETURN_LOCAL &&
+                   (bc == BC_PUSH_FIELD || bc == BC_PUSH_CONSTANT)) {
+            optimized.push_back(bc == BC_PUSH_FIELD ? BC_RETURN_FIELD
+                                                    : BC_RETURN_CONSTANT);
+            optimized.push_back(bytecode[i + 1]);
+            reachable = false;
+            i = next2;
+        } else if (bc == BC_POP && (bc2 == BC_RETURN_SELF ||
+                   bc2 == BC_RETURN_FIELD || bc2 == BC_RETURN_CONSTANT)) {
+            // the stack of a frame goes with it, nothing needs to be popped
+            // before a return
+            i = next;
+        } else {
+            int target = jumpTarget(bytecode, i);
+            if (target != -1)
+                jumps.push_back(std::make_pair(optimized.size(), target));
+            optimized.insert(optimized.end(), bytecode.begin() + i,
+                             bytecode.begin() + next);
+            reachable = !endsBasicBlock(bc);
+            i = next;
+            continue;
+        }
+        changed = true;
+    }
+    newIndex[size] = optimized.size();
+
+    if (!changed) return false;
+
+    // the code has shrunk, so the jumps get shorter
+    for (size_t j = 0; j < jumps.size(); ++j) {
+        size_t index = jumps[j].first;
+        int target = newIndex[jumps[j].second];
+        int offset = optimized[index] == BC_JUMP_BACKWARD ? index - target
+                                                          : target - index;
+        optimized[index + 1] = offset & 0xFF;
+        optimized[index + 2] = offset >> 8;
+        if (optimized[index] == BC_JUMP_IF_TRUE ||
+            optimized[index] == BC_JUMP_IF_FALSE) {
+            pVMArray inlined = (pVMArray)literals.Get(optimized[index + 3]);
+            int resume = INT_VAL((*inlined)[INLINED_RESUME]);
+            inlined->SetIndexableField(INLINED_RESUME,
+                (pVMObject)_UNIVERSE->NewInteger(newIndex[resume]));
+        }
+    }
+    bytecode.swap(optimized);
+    return true;
+}
+
+
+int MethodGenerationContext::NumberSendSites() {
+    // give every send its own inline cache, as long as the site index
+    // fits into the operand
+    int numSendSites = 0;
+    unsigned int i = 0;
+
+    while(i < bytecode.size()) {
+        if (Bytecode::IsSend(bytecode[i]) || bytecode[i] == BC_SUPER_SEND) {
+            if (numSendSites < NoInlineCache)
+                bytecode[i + 2] = numSendSites++;
+            else
+                bytecode[i + 2] = NoInlineCache;
+        }
+        i += Bytecode::GetBytecodeLength(bytecode[i]);
+    }
+
+    return numSendSites;
+}
+
+
 void MethodGenerationContext::SetHolder(ClassGenerationContext* holder) {
 	holderGenc = holder;
 }
@@ -51,8 +51,9 @@ public:
 	int8_t          FindLiteralIndex(pVMObject lit);
 	bool            FindVar(const StdString& var, int* index, 
                             int* context, bool* isArgument);
-	bool            FindField(const StdString& field);
+	bool            FindField(const StdString& field, int* index);
 	uint8_t         ComputeStackDepth();
+	int             NumberSendSites();
 
 	void            SetHolder(ClassGenerationContext* holder);
 	void            SetOuter(MethodGenerationContext* outer);
@@ -76,8 +77,21 @@ public:
 	bool            IsFinished();
 	void            RemoveLastBytecode() { bytecode.pop_back(); };
 	int             GetNumberOfArguments();
+	int             GetNumberOfLocals() { return locals.Size(); };
+	int             GetNumberOfBytecodes() { return bytecode.size(); };
 	void            AddBytecode(uint8_t bc);
+	void            SetBytecode(int index, uint8_t bc) { bytecode[index] = bc; };
+	int             AddInlinedVariables(MethodGenerationContext* block);
+	void            InlineCode(MethodGenerationContext* block, int firstLocal);
+	bool            IsCaptured();
+	void            AccessOuterContext(int context);
+	void            AccessHomeContext();
+	bool            IsClean() { return blockMethod && !outerContextAccessed; };
 private:
+	void            optimize();
+	bool            optimizePass();
+	void            classifyTrivial(pVMMethod meth);
+
 	ClassGenerationContext*    holderGenc;
     MethodGenerationContext*   outerGenc;
     bool                       blockMethod;
@@ -87,6 +101,7 @@ private:
     ExtendedList<StdString>    locals;
     ExtendedList<pVMObject>    literals;
     bool                       finished;
+    bool                       outerContextAccessed;
     std::vector<uint8_t>            bytecode;
 };
 
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "../vmobjects/VMPrimitive.h"
 #include "../vmobjects/VMObject.h"
 #include "../vmobjects/VMSymbol.h"
+#include "../vmobjects/Signature.h"
 
 #include "../vm/Universe.h"
 
@@ -53,6 +54,7 @@ Parser::Parser(istream& file) {
     lexer = new Lexer(file);
     bcGen = new BytecodeGenerator();
     nextSym = NONE;
+    errors = false;
 
     GETSYM;
 }
@@ -99,6 +101,7 @@ bool Parser::acceptOneOf(Symbol* ss) {
 bool Parser::expect(Symbol s) {
     if(accept(s))
         return true;
+    errors = true;
     fprintf(stderr, "Error: unexpected symbol in line %d. Expected %s, but found %s", 
             lexer->GetCurrentLineNumber(), symnames[s], symnames[sym]);
     if(_PRINTABLE_SYM)
@@ -111,6 +114,7 @@ bool Parser::expect(Symbol s) {
 bool Parser::expectOneOf(Symbol* ss) {
     if(acceptOneOf(ss))
         return true;
+    errors = true;
     fprintf(stderr, "Error: unexpected symbol in line %d. Expected one of ",
             lexer->GetCurrentLineNumber());
     while(*ss)
@@ -135,17 +139,23 @@ void Parser::genPushVariable(MethodGenerationContext* mgenc, const StdString& va
     bool is_argument = false;
     
     if(mgenc->FindVar(var, &index, &context, &is_argument)) {
+        mgenc->AccessOuterContext(context);
 		if(is_argument) 
             bcGen->EmitPUSHARGUMENT(mgenc, index, context);
-        else 
+        else
             bcGen->EmitPUSHLOCAL(mgenc, index, context);
-    } else if(mgenc->FindField(var)) {
-        pVMSymbol fieldName = _UNIVERSE->SymbolFor(var);
-		mgenc->AddLiteralIfAbsent((pVMObject)fieldName);
-        bcGen->EmitPUSHFIELD(mgenc, fieldName);
+    } else if(mgenc->FindField(var, &index)) {
+        mgenc->AccessHomeContext();
+        bcGen->EmitPUSHFIELD(mgenc, index);
     } else {
-        
-        pVMSymbol global = _UNIVERSE->SymbolFor(var);
+        //an unbound global is reported by sending unknownGlobal: to self,
+        //so a block reading one must keep its home context
+        if(var != "nil" && var != "true" && var != "false")
+            mgenc->AccessHomeContext();
+
+        //the method refers to the association the global is bound in
+        pVMArray global = 
+                _UNIVERSE->GetGlobalAssociation(_UNIVERSE->SymbolFor(var));
 		mgenc->AddLiteralIfAbsent((pVMObject)global);
         
         bcGen->EmitPUSHGLOBAL(mgenc, global);
@@ -163,9 +173,20 @@ void Parser::genPopVariable(MethodGenerationContext* mgenc, const StdString& var
     bool is_argument = false;
 	
     if(mgenc->FindVar(var, &index, &context, &is_argument)) {
+        mgenc->AccessOuterContext(context);
         if(is_argument) bcGen->EmitPOPARGUMENT(mgenc, index, context);
         else bcGen->EmitPOPLOCAL(mgenc, index, context);
-    } else bcGen->EmitPOPFIELD(mgenc, _UNIVERSE->SymbolFor(var));
+    } else if(mgenc->FindField(var, &index)) {
+        mgenc->AccessHomeContext();
+        bcGen->EmitPOPFIELD(mgenc, index);
+    } else {
+        errors = true;
+        fprintf(stderr, "Error: assignment to unknown variable %s in line %d: %s\n",
+                var.c_str(), lexer->GetCurrentLineNumber(),
+                lexer->GetRawBuffer().c_str());
+        // drop the value so the stack stays balanced until the parse ends
+        bcGen->EmitPOP(mgenc);
+    }
 }
 
 
@@ -205,6 +226,10 @@ void Parser::Classdef(ClassGenerationContext* cgenc) {
 //    	
     	cgenc->SetSuperName(_UNIVERSE->SymbolFor("Object"));
     }
+    // field accesses are compiled to slot indices, so the superclass' layout
+    // has to be known before the methods are parsed; only Object has none
+    if (cgenc->GetSuperName() != _UNIVERSE->SymbolFor("nil"))
+        cgenc->SetSuperClass(_UNIVERSE->LoadClass(cgenc->GetSuperName()));
 //    
 
     expect(NewTerm);
@@ -417,7 +442,9 @@ void Parser::blockBody(MethodGenerationContext* mgenc, bool seen_period) {
             // return the value of the last expression, regardless of whether it
             // was terminated with a . or not)
             mgenc->RemoveLastBytecode();
-		}
+		} else
+            // an empty block answers nil
+            genPushVariable(mgenc, "nil");
         bcGen->EmitRETURNLOCAL(mgenc);
 		
 		mgenc->SetFinished();
@@ -441,8 +468,10 @@ void Parser::blockBody(MethodGenerationContext* mgenc, bool seen_period) {
 void Parser::result(MethodGenerationContext* mgenc) {
     expression(mgenc);
 	
-	if(mgenc->IsBlockMethod()) bcGen->EmitRETURNNONLOCAL(mgenc);
-	else bcGen->EmitRETURNLOCAL(mgenc);
+	if(mgenc->IsBlockMethod()) {
+        mgenc->AccessHomeContext();
+        bcGen->EmitRETURNNONLOCAL(mgenc);
+    } else bcGen->EmitRETURNLOCAL(mgenc);
     
     mgenc->SetFinished(true);
 	accept(Period);
@@ -484,8 +513,6 @@ void Parser::assignments(MethodGenerationContext* mgenc, list<StdString>& l) {
 
 StdString Parser::assignment(MethodGenerationContext* mgenc) {
     StdString v = variable();
-    pVMSymbol var = _UNIVERSE->SymbolFor(v);
-	mgenc->AddLiteralIfAbsent((pVMObject)var);
     
     expect(Assign);
     
@@ -494,11 +521,24 @@ StdString Parser::assignment(MethodGenerationContext* mgenc) {
 
 
 void Parser::evaluation(MethodGenerationContext* mgenc) {
-    bool super;
-    primary(mgenc, &super);
+    bool super = false;
+    // the class of an integer literal is known, which allows inlining to:do:
+    bool integerReceiver = sym == Integer || sym == Minus;
+    if(sym == NewBlock) {
+        // a block receiving whileTrue: or whileFalse: is a loop's condition
+        MethodGenerationContext* bgenc = literalBlock(mgenc);
+        PEEK;
+        if(sym == Keyword && (text == "whileTrue:" || text == "whileFalse:") &&
+           nextSym == NewBlock) {
+            inlineWhileLoop(mgenc, bgenc);
+            return;
+        }
+        pushBlock(mgenc, bgenc);
+    } else
+        primary(mgenc, &super);
     if(sym == Identifier || sym == Keyword || sym == OperatorSequence ||
         symIn(binaryOpSyms)) {       
-        messages(mgenc, super);
+        messages(mgenc, super, integerReceiver);
     }
 }
 
@@ -520,20 +560,9 @@ void Parser::primary(MethodGenerationContext* mgenc, bool* super) {
         case NewTerm:
             nestedTerm(mgenc);
             break;
-        case NewBlock: {
-            MethodGenerationContext* bgenc = new MethodGenerationContext();
-			bgenc->SetIsBlockMethod(true);
-			bgenc->SetHolder(mgenc->GetHolder());
-			bgenc->SetOuter(mgenc);
-            
-            nestedBlock(bgenc);
-            
-            pVMMethod block_method = bgenc->Assemble();
-			mgenc->AddLiteral(block_method);
-            bcGen->EmitPUSHBLOCK(mgenc, block_method);
-			delete(bgenc);
+        case NewBlock:
+            pushBlock(mgenc, literalBlock(mgenc));
             break;
-        }
         default:
             literal(mgenc);
             break;
@@ -541,12 +570,46 @@ void Parser::primary(MethodGenerationContext* mgenc, bool* super) {
 }
 
 
+MethodGenerationContext* Parser::literalBlock(MethodGenerationContext* mgenc) {
+    // the block is pushed or inlined then
+    MethodGenerationContext* bgenc = new MethodGenerationContext();
+    bgenc->SetIsBlockMethod(true);
+    bgenc->SetHolder(mgenc->GetHolder());
+    bgenc->SetOuter(mgenc);
+    
+    nestedBlock(bgenc);
+    return bgenc;
+}
+
+
+void Parser::pushBlock(MethodGenerationContext* mgenc,
+                       MethodGenerationContext* bgenc) {
+    pVMMethod block_method = bgenc->Assemble();
+    // a clean block refers to nothing outside of itself, so a single
+    // instance serves all its evaluations. The classes of blocks are
+    // there once the bootstrap has loaded them.
+    if(bgenc->IsClean() && block3Class != NULL &&
+       block_method->GetNumberOfArguments() <= 3) {
+        pVMBlock block = _UNIVERSE->NewBlock(block_method, 
+                (pVMFrame)nilObject, 
+                block_method->GetNumberOfArguments());
+        mgenc->AddLiteral((pVMObject)block);
+        bcGen->EmitPUSHCONSTANT(mgenc, (pVMObject)block);
+    } else {
+        mgenc->AddLiteral(block_method);
+        bcGen->EmitPUSHBLOCK(mgenc, block_method);
+    }
+    delete(bgenc);
+}
+
+
 StdString Parser::variable(void) {
     return identifier();
 }
 
 
-void Parser::messages(MethodGenerationContext* mgenc, bool super) {
+void Parser::messages(MethodGenerationContext* mgenc, bool super,
+                      bool integerReceiver) {
     if(sym == Identifier) {
         do {
             // only the first message in a sequence can be a super send
@@ -559,7 +622,7 @@ void Parser::messages(MethodGenerationContext* mgenc, bool super) {
         }
         
         if(sym == Keyword) {
-            keywordMessage(mgenc, false);
+            keywordMessage(mgenc, false, false);
         }
     } else if(sym == OperatorSequence || symIn(binaryOpSyms)) {
         do {
@@ -569,10 +632,10 @@ void Parser::messages(MethodGenerationContext* mgenc, bool super) {
         } while(sym == OperatorSequence || symIn(binaryOpSyms));
         
         if(sym == Keyword) {
-            keywordMessage(mgenc, false);
+            keywordMessage(mgenc, false, false);
         }
     } else
-        keywordMessage(mgenc, super);
+        keywordMessage(mgenc, super, integerReceiver);
 }
 
 
@@ -610,7 +673,16 @@ void Parser::binaryOperand(MethodGenerationContext* mgenc, bool* super) {
 }
 
 
-void Parser::keywordMessage(MethodGenerationContext* mgenc, bool super) {
+void Parser::keywordMessage(MethodGenerationContext* mgenc, bool super,
+                            bool integerReceiver) {
+    if(!super) {
+        if(integerReceiver && text == "to:") {
+            inlineToDo(mgenc);
+            return;
+        } else if(inlineConditional(mgenc))
+            return;
+    }
+    
     StdString kw;
     do {
         kw.append(keyword());
@@ -789,3 +861,242 @@ void Parser::blockArguments(MethodGenerationContext* mgenc) {
 }
 
 
+
+
+//
+// inlining of control structures
+//
+// ifTrue:, ifFalse:, ifTrue:ifFalse:, and:, or:, whileTrue:, whileFalse: and
+// to:do: are compiled to jumps when their block arguments are literal blocks.
+// Such a block is read once, as an ordinary block, and its code is copied
+// into the enclosing method. The block itself is kept for the message sent
+// when the condition turns out not to be a Boolean.
+//
+
+
+bool Parser::endsMessage(void) {
+    // anything else continues the message, or sends one to its last argument
+    return sym != Identifier && sym != Keyword && sym != OperatorSequence &&
+           !symIn(binaryOpSyms);
+}
+
+
+void Parser::argumentMessages(MethodGenerationContext* mgenc) {
+    // the unary and binary messages to a keyword argument, after its primary
+    while(sym == Identifier)
+        unaryMessage(mgenc, false);
+    while(sym == OperatorSequence || symIn(binaryOpSyms))
+        binaryMessage(mgenc, false);
+}
+
+
+void Parser::sendKeywordMessage(MethodGenerationContext* mgenc, StdString kw) {
+    // the rest of a keyword message, of which kw has been read already
+    while(sym == Keyword) {
+        kw.append(keyword());
+        formula(mgenc);
+    }
+    
+    pVMSymbol msg = _UNIVERSE->SymbolFor(kw);
+	mgenc->AddLiteralIfAbsent((pVMObject)msg);
+    bcGen->EmitSEND(mgenc, msg);
+}
+
+
+pVMArray Parser::inlinedMessage(MethodGenerationContext* mgenc,
+                                const StdString& selector) {
+    // the receiver and arguments are the value of the test until they are
+    // filled in
+    pVMSymbol signature = _UNIVERSE->SymbolFor(selector);
+    pVMArray inlined = _UNIVERSE->NewArray(INLINED_RECEIVER +
+        Signature::GetNumberOfArguments(signature));
+    inlined->SetIndexableField(INLINED_SELECTOR, (pVMObject)signature);
+    mgenc->AddLiteral((pVMObject)inlined);
+    return inlined;
+}
+
+
+void Parser::setResume(MethodGenerationContext* mgenc, pVMArray inlined) {
+    // the result of the sent message takes the place of the inlined code
+    (*inlined)[INLINED_RESUME] =
+        (pVMObject)_UNIVERSE->NewInteger(mgenc->GetNumberOfBytecodes());
+}
+
+
+void Parser::setBlock(pVMArray inlined, int index,
+                      MethodGenerationContext* bgenc) {
+    // the block inlined is assembled on its own after its code is copied
+    inlined->SetIndexableField(INLINED_RECEIVER + index,
+                               (pVMObject)bgenc->Assemble());
+    delete(bgenc);
+}
+
+
+void Parser::inlineWhileLoop(MethodGenerationContext* mgenc,
+                             MethodGenerationContext* condition) {
+    StdString kw(text);
+    accept(Keyword);
+    MethodGenerationContext* body = literalBlock(mgenc);
+    // blocks in the loop may not refer to its variables, which are fresh in
+    // every iteration
+    if(!endsMessage() || condition->GetNumberOfArguments() != 1 ||
+       body->GetNumberOfArguments() != 1 || condition->IsCaptured() ||
+       body->IsCaptured()) {
+        pushBlock(mgenc, condition);
+        pushBlock(mgenc, body);
+        argumentMessages(mgenc);
+        sendKeywordMessage(mgenc, kw);
+        return;
+    }
+    
+    // [ condition ] whileTrue: [ body ] answers nil. If the condition isn't a
+    // Boolean, the condition block continues the loop with its value.
+    pVMArray inlined = inlinedMessage(mgenc, kw + "afterCondition:");
+    int loop = mgenc->GetNumberOfBytecodes();
+    inlinedBlock(mgenc, condition);
+    int exit = kw == "whileTrue:" ? bcGen->EmitJUMPIFFALSE(mgenc, inlined)
+                                  : bcGen->EmitJUMPIFTRUE(mgenc, inlined);
+    inlinedBlock(mgenc, body);
+    bcGen->EmitPOP(mgenc);
+    bcGen->EmitJUMPBACKWARD(mgenc, loop);
+    bcGen->PatchJump(mgenc, exit);
+    genPushVariable(mgenc, "nil");
+    setResume(mgenc, inlined);
+    setBlock(inlined, 0, condition);
+    setBlock(inlined, 1, body);
+}
+
+
+bool Parser::inlineConditional(MethodGenerationContext* mgenc) {
+    StdString kw(text);
+    // the jump over the first block is taken on this value, the message then
+    // answers the second block's value or the default
+    bool jumpOnTrue;
+    const char* otherwise;
+    if(kw == "ifTrue:")       { jumpOnTrue = false; otherwise = "nil";   }
+    else if(kw == "ifFalse:") { jumpOnTrue = true;  otherwise = "nil";   }
+    else if(kw == "and:")     { jumpOnTrue = false; otherwise = "false"; }
+    else if(kw == "or:")      { jumpOnTrue = true;  otherwise = "true";  }
+    else return false;
+    
+    PEEK;
+    if(nextSym != NewBlock)
+        return false;
+    accept(Keyword);
+    MethodGenerationContext* first = literalBlock(mgenc);
+    MethodGenerationContext* second = NULL;
+    if(kw == "ifTrue:" && sym == Keyword && text == "ifFalse:") {
+        PEEK;
+        if(nextSym == NewBlock) {
+            kw += text;
+            accept(Keyword);
+            second = literalBlock(mgenc);
+        }
+    }
+    if(!endsMessage() || first->GetNumberOfArguments() != 1 ||
+       (second != NULL && second->GetNumberOfArguments() != 1)) {
+        pushBlock(mgenc, first);
+        if(second != NULL) pushBlock(mgenc, second);
+        argumentMessages(mgenc);
+        sendKeywordMessage(mgenc, kw);
+        return true;
+    }
+    
+    // if the condition isn't a Boolean, it receives the message
+    pVMArray inlined = inlinedMessage(mgenc, kw);
+    int skip = jumpOnTrue ? bcGen->EmitJUMPIFTRUE(mgenc, inlined)
+                          : bcGen->EmitJUMPIFFALSE(mgenc, inlined);
+    inlinedBlock(mgenc, first);
+    int end = bcGen->EmitJUMP(mgenc);
+    bcGen->PatchJump(mgenc, skip);
+    if(second != NULL)
+        inlinedBlock(mgenc, second);
+    else
+        genPushVariable(mgenc, otherwise);
+    bcGen->PatchJump(mgenc, end);
+    setResume(mgenc, inlined);
+    setBlock(inlined, 1, first);
+    if(second != NULL) setBlock(inlined, 2, second);
+    return true;
+}
+
+
+void Parser::inlineToDo(MethodGenerationContext* mgenc) {
+    // the receiver is an integer literal, so this is Integer>>to:do:, which
+    // answers the receiver
+    accept(Keyword);
+    formula(mgenc);
+    PEEK;
+    if(sym != Keyword || text != "do:" || nextSym != NewBlock) {
+        sendKeywordMessage(mgenc, "to:");
+        return;
+    }
+    accept(Keyword);
+    MethodGenerationContext* block = literalBlock(mgenc);
+    if(!endsMessage() || block->GetNumberOfArguments() != 2 ||
+       block->IsCaptured()) {
+        pushBlock(mgenc, block);
+        argumentMessages(mgenc);
+        sendKeywordMessage(mgenc, "to:do:");
+        return;
+    }
+    
+    pVMSymbol lessOrEqual = _UNIVERSE->SymbolFor("<=");
+    pVMSymbol plus = _UNIVERSE->SymbolFor("+");
+    pVMObject one = (pVMObject)_UNIVERSE->NewInteger(1);
+    mgenc->AddLiteralIfAbsent((pVMObject)lessOrEqual);
+    mgenc->AddLiteralIfAbsent((pVMObject)plus);
+    mgenc->AddLiteralIfAbsent(one);
+    
+    int counter = mgenc->GetNumberOfLocals();
+    mgenc->AddLocal("$counter");
+    int limit = mgenc->GetNumberOfLocals();
+    mgenc->AddLocal("$limit");
+    bcGen->EmitPOPLOCAL(mgenc, limit, 0);
+    bcGen->EmitDUP(mgenc);
+    bcGen->EmitPOPLOCAL(mgenc, counter, 0);
+    
+    // if the comparison doesn't answer a Boolean, the counter continues the
+    // loop with its value
+    pVMArray inlined = inlinedMessage(mgenc, "to:do:afterTest:");
+    inlined->SetIndexableField(INLINED_RECEIVER,
+                               (pVMObject)_UNIVERSE->NewInteger(counter));
+    inlined->SetIndexableField(INLINED_RECEIVER + 1,
+                               (pVMObject)_UNIVERSE->NewInteger(limit));
+    int loop = mgenc->GetNumberOfBytecodes();
+    bcGen->EmitPUSHLOCAL(mgenc, counter, 0);
+    bcGen->EmitPUSHLOCAL(mgenc, limit, 0);
+    bcGen->EmitSEND(mgenc, lessOrEqual);
+    int exit = bcGen->EmitJUMPIFFALSE(mgenc, inlined);
+    inlinedBlock(mgenc, block, counter);
+    bcGen->EmitPOP(mgenc);
+    bcGen->EmitPUSHLOCAL(mgenc, counter, 0);
+    bcGen->EmitPUSHCONSTANT(mgenc, one);
+    bcGen->EmitSEND(mgenc, plus);
+    bcGen->EmitPOPLOCAL(mgenc, counter, 0);
+    bcGen->EmitJUMPBACKWARD(mgenc, loop);
+    // the receiver stays on the stack, below the result of that message
+    setResume(mgenc, inlined);
+    bcGen->EmitPOP(mgenc);
+    bcGen->PatchJump(mgenc, exit);
+    setBlock(inlined, 2, block);
+}
+
+
+void Parser::inlinedBlock(MethodGenerationContext* mgenc,
+                          MethodGenerationContext* bgenc, int counter) {
+    // the block's arguments and locals become locals of the enclosing method
+    int firstLocal = mgenc->AddInlinedVariables(bgenc);
+    // the argument of a to:do: block is the loop counter
+    if(counter != -1) {
+        bcGen->EmitPUSHLOCAL(mgenc, counter, 0);
+        bcGen->EmitPOPLOCAL(mgenc, firstLocal, 0);
+    }
+    // locals are nil whenever a block is evaluated
+    int firstBlockLocal = firstLocal + bgenc->GetNumberOfArguments() - 1;
+    for(int i = firstBlockLocal; i < mgenc->GetNumberOfLocals(); ++i) {
+        genPushVariable(mgenc, "nil");
+        bcGen->EmitPOPLOCAL(mgenc, i, 0);
+    }
+    mgenc->InlineCode(bgenc, firstLocal);
+}
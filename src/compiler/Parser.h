@@ -46,6 +46,8 @@ public:
 	~Parser();
 
 	void Classdef(ClassGenerationContext* cgenc);
+	//set once a syntax error has been reported, the class is not loaded then
+	bool HasErrors() const { return errors; }
 private:	
 	bool        eob(void);
 
@@ -80,11 +82,13 @@ private:
 	void        evaluation(MethodGenerationContext* mgenc);
 	void        primary(MethodGenerationContext* mgenc, bool* super);
 	StdString     variable(void);
-	void        messages(MethodGenerationContext* mgenc, bool super);
+	void        messages(MethodGenerationContext* mgenc, bool super,
+                         bool integerReceiver);
 	void        unaryMessage(MethodGenerationContext* mgenc, bool super);
 	void        binaryMessage(MethodGenerationContext* mgenc, bool super);
 	void        binaryOperand(MethodGenerationContext* mgenc, bool* super);
-	void        keywordMessage(MethodGenerationContext* mgenc, bool super);
+	void        keywordMessage(MethodGenerationContext* mgenc, bool super,
+                               bool integerReceiver);
 	void        formula(MethodGenerationContext* mgenc);
 	void        nestedTerm(MethodGenerationContext* mgenc);
 	void        literal(MethodGenerationContext* mgenc);
@@ -102,6 +106,24 @@ private:
 	void        blockArguments(MethodGenerationContext* mgenc);
 	void        genPushVariable(MethodGenerationContext*, const StdString&);
 	void        genPopVariable(MethodGenerationContext*, const StdString&);
+	MethodGenerationContext* literalBlock(MethodGenerationContext* mgenc);
+	void        pushBlock(MethodGenerationContext* mgenc,
+                          MethodGenerationContext* bgenc);
+
+	bool        endsMessage(void);
+	void        argumentMessages(MethodGenerationContext* mgenc);
+	void        sendKeywordMessage(MethodGenerationContext* mgenc, StdString kw);
+	pVMArray    inlinedMessage(MethodGenerationContext* mgenc,
+                               const StdString& selector);
+	void        setResume(MethodGenerationContext* mgenc, pVMArray inlined);
+	void        setBlock(pVMArray inlined, int index,
+                         MethodGenerationContext* bgenc);
+	void        inlineWhileLoop(MethodGenerationContext* mgenc,
+                                MethodGenerationContext* condition);
+	bool        inlineConditional(MethodGenerationContext* mgenc);
+	void        inlineToDo(MethodGenerationContext* mgenc);
+	void        inlinedBlock(MethodGenerationContext* mgenc,
+                             MethodGenerationContext* bgenc, int counter = -1);
 
 	Lexer* lexer;
 	
@@ -114,6 +136,8 @@ private:
     StdString nextText;
 	
     BytecodeGenerator* bcGen;
+
+    bool errors;
 };
 
 #endif
@@ -62,10 +62,21 @@ pVMClass SourcecodeCompiler::CompileClass( const StdString& path,
 		return NULL;
 	}
 //	
-    if (parser != NULL) delete(parser);
+    // the parser loads the superclass, which may compile another class
+    // before this one is done
+    Parser* outer = parser;
     parser = new Parser(*fp);
 //    
     result = compile(systemClass);
+//    
+    delete(parser);
+    parser = outer;
+    delete(fp);
+//    
+    if (result == NULL) {
+        showCompilationError(file, "syntax errors, see above");
+        return NULL;
+    }
 //    
     pVMSymbol cname = result->GetName();
     StdString cnameC = cname->GetStdString();
@@ -79,10 +90,6 @@ pVMClass SourcecodeCompiler::CompileClass( const StdString& path,
 //        
         return NULL;
     }
-//    
-    delete(parser);
-    parser = NULL;
-    delete(fp);
 #ifdef COMPILER_DEBUG
     std::cout << "Compilation finished" << endl;
 #endif
@@ -94,12 +101,12 @@ pVMClass SourcecodeCompiler::CompileClass( const StdString& path,
 pVMClass SourcecodeCompiler::CompileClassString( const StdString& stream, 
                                                 pVMClass systemClass ) {
     istringstream* ss = new istringstream(stream);
-    if (parser != NULL) delete(parser);
+    Parser* outer = parser;
     parser = new Parser(*ss);
     
     pVMClass result = compile(systemClass);
     delete(parser);
-    parser = NULL;
+    parser = outer;
     delete(ss);
 
     return result;
@@ -124,6 +131,11 @@ pVMClass SourcecodeCompiler::compile( pVMClass systemClass ) {
     pVMClass result = systemClass;
 //    
     parser->Classdef(cgc);
+//    
+    if (parser->HasErrors()) {
+        delete(cgc);
+        return NULL;
+    }
 //    
     if (systemClass == NULL) result = cgc->Assemble();
     else cgc->AssembleSystemClass(result);
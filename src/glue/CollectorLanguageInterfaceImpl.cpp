@@ -27,6 +27,8 @@
 #endif /* OMR_GC_MODRON_CONCURRENT_MARK */
 #if defined(OMR_GC_MODRON_COMPACTION)
 #include "CompactScheme.hpp"
+#include "HeapMapIterator.hpp"
+#include "MarkMap.hpp"
 #endif /* OMR_GC_MODRON_COMPACTION */
 #include "EnvironmentStandard.hpp"
 #include "ForwardedHeader.hpp"
@@ -49,12 +51,22 @@
 
 // TODD @A1A Begin
 //#define TODD_DEBUG
-static omrobjectptr_t UninterruptableAllocationObjectArray[1024*64];
+static omrobjectptr_t *UninterruptableAllocationObjectArray = NULL;
+static int UninterruptableAllocationObjectCapacity = 0;
 static int UninterruptableAllocationObjectCount = 0;
 static int MaxUninterruptableAllocationObjectCount = 0;
 
 void addUninterruptableAllocationObject(omrobjectptr_t objptr)
 {   
+    if (UninterruptableAllocationObjectCount == UninterruptableAllocationObjectCapacity)
+    {   /* class loading allocates a lot before the handles are released */
+        UninterruptableAllocationObjectCapacity = (0 == UninterruptableAllocationObjectCapacity) ? 1024*64 : 2*UninterruptableAllocationObjectCapacity;
+        UninterruptableAllocationObjectArray = (omrobjectptr_t *)realloc(UninterruptableAllocationObjectArray, UninterruptableAllocationObjectCapacity*sizeof(omrobjectptr_t));
+        if (NULL == UninterruptableAllocationObjectArray) {
+            fprintf(stderr, "failed to grow the allocation handles!\n");
+            abort();
+        }
+    }
     UninterruptableAllocationObjectArray[UninterruptableAllocationObjectCount++] = objptr;   
     if( UninterruptableAllocationObjectCount > MaxUninterruptableAllocationObjectCount)
     {   MaxUninterruptableAllocationObjectCount = UninterruptableAllocationObjectCount;
@@ -65,6 +77,32 @@ void removeAllUninterruptableAllocationObject()
 {   UninterruptableAllocationObjectCount = 0;    
 }
 // TODD @A1A End
+
+
+#if defined(OMR_GC_MODRON_COMPACTION)
+/* RootWalker updating a root slot to the new location of its object */
+struct FixupRootsData {
+	MM_CompactScheme *compactScheme;
+	void *heapBase;
+	void *heapTop;
+};
+
+static void
+fixupRoot(pVMObject *slot, void *data)
+{
+	FixupRootsData *fixupData = (FixupRootsData *)data;
+	/* the frame chain leads through frames on the heap, whose slots were fixed up with the frames. Fixing
+	 * them up again would take their new locations for old ones.
+	 */
+	if (((void *)slot >= fixupData->heapBase) && ((void *)slot < fixupData->heapTop)) {
+		return;
+	}
+	/* objects outside of the compacted range, like the frames on the interpreter's native stack, keep their address */
+	if ((NULL != *slot) && !IS_TAGGED(*slot)) {
+		*slot = (pVMObject)fixupData->compactScheme->getForwardingPtr((omrobjectptr_t)*slot);
+	}
+}
+#endif /* OMR_GC_MODRON_COMPACTION */
 /* This enum extends ConcurrentStatus with values > CONCURRENT_ROOT_TRACING. Values from this
  * and from ConcurrentStatus are treated as uintptr_t values everywhere except when used as
  * case labels in switch() statements where manifest constants are required.
@@ -156,17 +194,28 @@ MM_CollectorLanguageInterfaceImpl::markingScheme_masterSetupForGC(MM_Environment
 {
 }
 
+/* RootWalker marking the object of a root slot */
+struct MarkRootsData {
+	MM_EnvironmentBase *env;
+	MM_MarkingScheme *markingScheme;
+};
+
+static void
+markRoot(pVMObject *slot, void *data)
+{
+	MarkRootsData *markData = (MarkRootsData *)data;
+	/* globals may hold tagged integers, which are no heap references */
+	if ((NULL != *slot) && !IS_TAGGED(*slot)) {
+		markData->markingScheme->markObject(markData->env, (omrobjectptr_t)*slot);
+	}
+}
+
 void
 MM_CollectorLanguageInterfaceImpl::markingScheme_scanRoots(MM_EnvironmentBase *env)
 {
-	OMR_VM_Example *omrVM = (OMR_VM_Example *)env->getOmrVM()->_language_vm;
-	J9HashTableState state;
-	RootEntry *rEntry = NULL;
-	rEntry = (RootEntry *)hashTableStartDo(omrVM->rootTable, &state);
-	while (rEntry != NULL) {
-		_markingScheme->markObject(env, rEntry->rootPtr);
-		rEntry = (RootEntry *)hashTableNextDo(&state);
-	}
+	/* globals, symbols, the interpreter's frame chain and the objects the VM refers to directly */
+	MarkRootsData markData = {env, _markingScheme};
+	_UNIVERSE->WalkRoots(markRoot, &markData);
     
 #ifdef TODD_DEBUG 
     printf("ScanRoot for Uninterrupt Object, count=%d, max=%d\n"
@@ -197,6 +246,10 @@ void
 MM_CollectorLanguageInterfaceImpl::markingScheme_masterCleanupAfterGC(MM_EnvironmentBase *env)
 {
 	OMR_VM_Example *omrVM = (OMR_VM_Example *)env->getOmrVM()->_language_vm;
+	if (NULL == omrVM->objectTable) {
+		/* heap debugging is off, there is no side table to prune */
+		return;
+	}
 	J9HashTableState state;
 	ObjectEntry *rEntry = NULL;
 	rEntry = (ObjectEntry *)hashTableStartDo(omrVM->objectTable, &state);
@@ -211,12 +264,16 @@ MM_CollectorLanguageInterfaceImpl::markingScheme_masterCleanupAfterGC(MM_Environ
 uintptr_t
 MM_CollectorLanguageInterfaceImpl::markingScheme_scanObject(MM_EnvironmentBase *env, omrobjectptr_t objectPtr, MarkingSchemeScanReason reason)
 {
-	int totalfields = ((pVMObject)objectPtr)->GetNumberOfMarkableFields();
-	for(int i =0 ; i<totalfields;i++){
-		omrobjectptr_t  onefield = (omrobjectptr_t)(((pVMObject)objectPtr)->GetMarkableFieldObj(i));
-			if (NULL != onefield && _markingScheme->isHeapObject(onefield)) {
-				_markingScheme->markObject(env, onefield);
+	ReferenceRunIterator runs((pVMObject)objectPtr);
+	pVMObject *slots = NULL;
+	int length = 0;
+	while (runs.Next(slots, length)) {
+		for (int i = 0; i < length; i++) {
+			omrobjectptr_t field = (omrobjectptr_t)slots[i];
+			if (NULL != field && !IS_TAGGED(field) && _markingScheme->isHeapObject(field)) {
+				_markingScheme->inlineMarkObjectNoCheck(env, field);
 			}
+		}
 	}
 	return env->getExtensions()->objectModel.getSizeInBytesWithHeader(objectPtr);
 }
@@ -401,28 +458,80 @@ MM_CollectorLanguageInterfaceImpl::scavenger_fixupDestroyedSlot(MM_EnvironmentBa
 #endif /* OMR_GC_MODRON_SCAVENGER */
 
 #if defined(OMR_GC_MODRON_COMPACTION)
+CompactPreventedReason
+MM_CollectorLanguageInterfaceImpl::parallelGlobalGC_checkIfCompactionShouldBePrevented(MM_EnvironmentBase *env)
+{
+	/* C++ code holds objects in locals across allocations, which compaction would not update. Only the
+	 * interpreter's safepoint may compact, any other collection defers the compaction to it.
+	 */
+	if (!Heap::IsAtSafepoint()) {
+		Heap::RequestCompaction();
+		return COMPACT_PREVENTED_CRITICAL_REGIONS;
+	}
+	return COMPACT_PREVENTED_NONE;
+}
+
 void
 MM_CollectorLanguageInterfaceImpl::compactScheme_verifyHeap(MM_EnvironmentBase *env, MM_MarkMap *markMap)
 {
-	Assert_MM_unimplemented();
+	/* every reference of a live object must refer to a live object, or to a frame on the native stack */
+	MM_GCExtensionsBase *extensions = env->getExtensions();
+	void *heapBase = extensions->heap->getHeapBase();
+	void *heapTop = extensions->heap->getHeapTop();
+	MM_HeapMapIterator markedObjectIterator(extensions, markMap, (uintptr_t *)heapBase, (uintptr_t *)heapTop);
+	omrobjectptr_t objectPtr = NULL;
+	while (NULL != (objectPtr = markedObjectIterator.nextObject())) {
+		ReferenceRunIterator runs((pVMObject)objectPtr);
+		pVMObject *slots = NULL;
+		int length = 0;
+		while (runs.Next(slots, length)) {
+			for (int i = 0; i < length; i++) {
+				pVMObject field = slots[i];
+				if ((NULL != field) && !IS_TAGGED(field) && ((void *)field >= heapBase) && ((void *)field < heapTop)) {
+					Assert_MM_true(markMap->isBitSet((omrobjectptr_t)field));
+				}
+			}
+		}
+	}
 }
 
 void
 MM_CollectorLanguageInterfaceImpl::compactScheme_fixupRoots(MM_EnvironmentBase *env, MM_CompactScheme *compactScheme)
 {
-	Assert_MM_unimplemented();
+	/* all GC threads get here, the roots are updated by one of them */
+	if (env->_currentTask->synchronizeGCThreadsAndReleaseSingleThread(env, UNIQUE_ID)) {
+		/* globals, symbols, the interpreter's frame chain and the objects the VM refers to directly */
+		MM_GCExtensionsBase *extensions = env->getExtensions();
+		FixupRootsData fixupData = {compactScheme, extensions->heap->getHeapBase(), extensions->heap->getHeapTop()};
+		_UNIVERSE->WalkRoots(fixupRoot, &fixupData);
+		/* C++ code that allocates reads the moved objects back from the handles */
+		for (int i = 0; i < UninterruptableAllocationObjectCount; ++i) {
+			fixupRoot((pVMObject *)&UninterruptableAllocationObjectArray[i], &fixupData);
+		}
+
+		OMR_VM_Example *omrVM = (OMR_VM_Example *)env->getOmrVM()->_language_vm;
+		if (NULL != omrVM->objectTable) {
+			J9HashTableState state;
+			ObjectEntry *objectEntry = (ObjectEntry *)hashTableStartDo(omrVM->objectTable, &state);
+			while (NULL != objectEntry) {
+				objectEntry->objPtr = compactScheme->getForwardingPtr(objectEntry->objPtr);
+				objectEntry = (ObjectEntry *)hashTableNextDo(&state);
+			}
+		}
+		env->_currentTask->releaseSynchronizedGCThreads(env);
+	}
 }
 
 void
 MM_CollectorLanguageInterfaceImpl::compactScheme_workerCleanupAfterGC(MM_EnvironmentBase *env)
 {
-	Assert_MM_unimplemented();
+	/* the VM keeps no per thread state about object locations */
 }
 
 void
 MM_CollectorLanguageInterfaceImpl::compactScheme_languageMasterSetupForGC(MM_EnvironmentBase *env)
 {
-	Assert_MM_unimplemented();
+	/* the roots are only fixed up once all objects moved, see compactScheme_fixupRoots */
 }
 #endif /* OMR_GC_MODRON_COMPACTION */
 
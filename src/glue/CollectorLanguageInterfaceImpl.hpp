@@ -96,7 +96,7 @@ public:
 	virtual void parallelGlobalGC_destroyHeapWalker(MM_EnvironmentBase *env) {}
 	virtual MM_HeapWalker *parallelGlobalGC_getHeapWalker() {return NULL;}
 #if defined(OMR_GC_MODRON_COMPACTION)
-	virtual CompactPreventedReason parallelGlobalGC_checkIfCompactionShouldBePrevented(MM_EnvironmentBase *env) {return COMPACT_PREVENTED_NONE;}
+	virtual CompactPreventedReason parallelGlobalGC_checkIfCompactionShouldBePrevented(MM_EnvironmentBase *env);
 #endif /* OMR_GC_MODRON_COMPACTION */
 	virtual void parallelGlobalGC_masterThreadGarbageCollect_gcComplete(MM_EnvironmentBase *env, bool didCompact) {}
 	virtual void parallelGlobalGC_collectorInitialized(MM_EnvironmentBase *env) {}
@@ -21,20 +21,32 @@
 
 #include "CompactSchemeFixupObject.hpp"
 #include "EnvironmentStandard.hpp"
+#include "ModronAssertions.h"
 
 #if defined(OMR_GC_MODRON_COMPACTION)
 
 void
 MM_CompactSchemeFixupObject::fixupObject(MM_EnvironmentStandard *env, omrobjectptr_t objectPtr)
 {
-#error provide an implementation to fix objects during a compact
+	/* the object has already been moved, its slots still refer to the old locations of their objects */
+	ReferenceRunIterator runs((pVMObject)objectPtr);
+	pVMObject *slots = NULL;
+	int length = 0;
+	while (runs.Next(slots, length)) {
+		for (int i = 0; i < length; i++) {
+			if ((NULL != slots[i]) && !IS_TAGGED(slots[i])) {
+				slots[i] = (pVMObject)_compactScheme->getForwardingPtr((omrobjectptr_t)slots[i]);
+			}
+		}
+	}
 }
 
 
 void
 MM_CompactSchemeFixupObject::verifyForwardingPtr(omrobjectptr_t objectPtr, omrobjectptr_t forwardingPtr)
 {
-#error provide an implementation to verify objects after a compact is complete
+	/* objects are only moved to object aligned addresses */
+	Assert_MM_true(0 == ((uintptr_t)forwardingPtr & (sizeof(uintptr_t) - 1)));
 }
 
 #endif /* OMR_GC_MODRON_COMPACTION */
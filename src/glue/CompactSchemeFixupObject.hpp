@@ -24,6 +24,7 @@
 
 #include "CompactScheme.hpp"
 #include "GCExtensionsBase.hpp"
+#include "VMObject.h"
 
 #if defined(OMR_GC_MODRON_COMPACTION)
 
@@ -31,11 +32,7 @@ class MM_CompactSchemeFixupObject {
 public:
 protected:
 private:
-	/*
-	OMR_VM *_omrVM;
-	MM_GCExtensionsBase *_extensions;
 	MM_CompactScheme *_compactScheme;
-	*/
 public:
 
 	/**
@@ -48,10 +45,8 @@ public:
 	static void verifyForwardingPtr(omrobjectptr_t objectPtr, omrobjectptr_t forwardingPtr);
 
 	MM_CompactSchemeFixupObject(MM_EnvironmentBase* env, MM_CompactScheme *compactScheme)
-/*	:
-		_omrVM(env->getOmrVM()),
-		_extensions(env->getExtensions()),
-		_compactScheme(compactScheme)*/
+	:
+		_compactScheme(compactScheme)
 	{}
 
 protected:
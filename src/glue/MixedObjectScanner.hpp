@@ -22,13 +22,21 @@
 #include "GCExtensionsBase.hpp"
 #include "ObjectModel.hpp"
 #include "ObjectScanner.hpp"
+#include "VMObject.h"
 
+/**
+ * Scans the reference slots of any SOM object. The reference map of the object
+ * tells which runs of contiguous slots hold references (its class, object fields,
+ * indexable fields, literals and inline cache entries), so raw fields such as
+ * bytecodes, characters or embedded numbers are never seen by the scanner.
+ */
 class GC_MixedObjectScanner : public GC_ObjectScanner
 {
 	/* Data Members */
 private:
-	fomrobject_t * const _endPtr;	/**< end scan pointer */
-	fomrobject_t *_mapPtr;			/**< pointer to first slot in current scan segment */
+	ReferenceRunIterator _runs;		/**< the runs of reference slots of the object */
+	pVMObject *_runStart;			/**< first slot of the current run not yet mapped */
+	int _runLength;					/**< number of slots of the current run not yet mapped, 0 if there are no more */
 
 protected:
 
@@ -36,6 +44,36 @@ public:
 
 	/* Member Functions */
 private:
+	/**
+	 * Map the next slots of the current run, at most _bitsPerScanMap of them. Slots
+	 * holding tagged integers are left out, they are no references.
+	 * @param[out] slotMap the slot map of the mapped slots
+	 * @param[out] hasNextSlotMap set if reference slots remain after the mapped ones
+	 * @return pointer to the slot covered by the lowest bit of slotMap, NULL if there are no more slots
+	 */
+	MMINLINE fomrobject_t *
+	mapNextSlots(uintptr_t &slotMap, bool &hasNextSlotMap)
+	{
+		fomrobject_t *mapPtr = (fomrobject_t *)_runStart;
+		slotMap = 0;
+		if (0 < _runLength) {
+			intptr_t slots = OMR_MIN(_runLength, _bitsPerScanMap);
+			for (intptr_t bit = 0; bit < slots; bit++) {
+				if (0 == (mapPtr[bit] & 1)) {
+					slotMap |= ((uintptr_t)1) << bit;
+				}
+			}
+			_runStart += slots;
+			_runLength -= slots;
+			if (0 == _runLength) {
+				_runs.Next(_runStart, _runLength);
+			}
+		} else {
+			mapPtr = NULL;
+		}
+		hasNextSlotMap = 0 < _runLength;
+		return mapPtr;
+	}
 
 protected:
 	/**
@@ -44,11 +82,13 @@ protected:
 	 * @param[in] flags Scanning context flags
 	 */
 	GC_MixedObjectScanner(MM_EnvironmentStandard *env, omrobjectptr_t objectPtr, uintptr_t flags)
-		: GC_ObjectScanner(env, objectPtr, (fomrobject_t *)objectPtr + 1, 0, flags, 0)
-		, _endPtr((fomrobject_t *)((uint8_t*)objectPtr + MM_GCExtensionsBase::getExtensions(env->getOmrVM())->objectModel.getConsumedSizeInBytesWithHeader(objectPtr)))
-		, _mapPtr(_scanPtr)
+		: GC_ObjectScanner(env, objectPtr, NULL, 0, flags, 0)
+		, _runs((pVMObject)objectPtr)
+		, _runStart(NULL)
+		, _runLength(0)
 	{
 		_typeId = __FUNCTION__;
+		_runs.Next(_runStart, _runLength);
 	}
 
 	/**
@@ -60,16 +100,9 @@ protected:
 	{
 		GC_ObjectScanner::initialize(env);
 
-		intptr_t slotCount = _endPtr - _scanPtr;
-
-		/* Initialize the slot map assuming all slots are reference slots or NULL */
-		if (slotCount < _bitsPerScanMap) {
-			_scanMap = (((uintptr_t)1) << slotCount) - 1;
-			_flags = setNoMoreSlots(_flags, true);
-		} else {
-			_scanMap = ~((uintptr_t)0);
-			_flags = setNoMoreSlots(_flags, slotCount == _bitsPerScanMap);
-		}
+		bool hasNextSlotMap = false;
+		_scanPtr = mapNextSlots(_scanMap, hasNextSlotMap);
+		_flags = setNoMoreSlots(_flags, !hasNextSlotMap);
 	}
 
 public:
@@ -99,19 +132,7 @@ public:
 	virtual fomrobject_t *
 	getNextSlotMap(uintptr_t &slotMap, bool &hasNextSlotMap)
 	{
-		intptr_t slotCount = _endPtr - _scanPtr;
-
-		/* Initialize the slot map assuming all slots are reference slots or NULL */
-		if (slotCount < _bitsPerScanMap) {
-			slotMap = (((uintptr_t)1) << slotCount) - 1;
-			hasNextSlotMap = false;
-		} else {
-			slotMap = ~((uintptr_t)0);
-			hasNextSlotMap = slotCount > _bitsPerScanMap;
-		}
-
-		_mapPtr += _bitsPerScanMap;
-		return _mapPtr;
+		return mapNextSlots(slotMap, hasNextSlotMap);
 	}
 };
 
@@ -64,9 +64,14 @@ public:
 	 */
 	MMINLINE GC_SlotObject *nextSlot()
 	{
-		if (_scanPtr < _endPtr) {
-			_slotObject.writeAddressToSlot(_scanPtr);
+		while (_scanPtr < _endPtr) {
+			fomrobject_t *slot = _scanPtr;
 			_scanPtr += 1;
+			/* tagged integers are no references */
+			if (IS_TAGGED(*slot)) {
+				continue;
+			}
+			_slotObject.writeAddressToSlot(slot);
 			return &_slotObject;
 		}
 		return NULL;
@@ -152,7 +152,8 @@ public:
 	MMINLINE bool
 	isDeadObject(void *objectPtr)
 	{
-		return J9_GC_OBJ_HEAP_HOLE == (OMR_OBJECT_FLAGS(objectPtr) & J9_GC_OBJ_HEAP_HOLE_MASK);
+		/* holes are tagged in their first slot, where live objects have their (aligned) vtable pointer */
+		return J9_GC_OBJ_HEAP_HOLE == (*(uintptr_t *)objectPtr & J9_GC_OBJ_HEAP_HOLE);
 	}
 
 	/**
@@ -163,7 +164,7 @@ public:
 	MMINLINE bool
 	isSingleSlotDeadObject(omrobjectptr_t objectPtr)
 	{
-		return J9_GC_SINGLE_SLOT_HOLE == (OMR_OBJECT_FLAGS(objectPtr) & J9_GC_OBJ_HEAP_HOLE_MASK);
+		return J9_GC_SINGLE_SLOT_HOLE == (*(uintptr_t *)objectPtr & J9_GC_OBJ_HEAP_HOLE_MASK);
 	}
 
 	/**
@@ -205,8 +206,8 @@ public:
 	MMINLINE uintptr_t
 	getConsumedSizeInSlotsWithHeader(omrobjectptr_t objectPtr)
 	{
-		Assert_MM_unimplemented();
-		return 0;
+		/* the compactor walks the heap in slots */
+		return getConsumedSizeInBytesWithHeader(objectPtr) / sizeof(uintptr_t);
 	}
 
 	MMINLINE uintptr_t
@@ -58,17 +58,21 @@ public:
 	{
 		J9HashTableState state;
 		OMR_VM_Example *omrVM = (OMR_VM_Example *)env->getOmrVM()->_language_vm;
-		RootEntry *rootEntry = (RootEntry *)hashTableStartDo(omrVM->rootTable, &state);
-		while (rootEntry != NULL) {
-			_scavenger->backOutFixSlotWithoutCompression((volatile omrobjectptr_t *) &rootEntry->rootPtr);
-			rootEntry = (RootEntry *)hashTableNextDo(&state);
+		if (NULL != omrVM->rootTable) {
+			RootEntry *rootEntry = (RootEntry *)hashTableStartDo(omrVM->rootTable, &state);
+			while (rootEntry != NULL) {
+				_scavenger->backOutFixSlotWithoutCompression((volatile omrobjectptr_t *) &rootEntry->rootPtr);
+				rootEntry = (RootEntry *)hashTableNextDo(&state);
+			}
 		}
-		ObjectEntry *objectEntry = (ObjectEntry *)hashTableStartDo(omrVM->objectTable, &state);
-		while (NULL != objectEntry) {
-			if (NULL != objectEntry->objPtr) {
-				_scavenger->backOutFixSlotWithoutCompression((volatile omrobjectptr_t *) &objectEntry->objPtr);
+		if (NULL != omrVM->objectTable) {
+			ObjectEntry *objectEntry = (ObjectEntry *)hashTableStartDo(omrVM->objectTable, &state);
+			while (NULL != objectEntry) {
+				if (NULL != objectEntry->objPtr) {
+					_scavenger->backOutFixSlotWithoutCompression((volatile omrobjectptr_t *) &objectEntry->objPtr);
+				}
+				objectEntry = (ObjectEntry *)hashTableNextDo(&state);
 			}
-			objectEntry = (ObjectEntry *)hashTableNextDo(&state);
 		}
 	}
 };
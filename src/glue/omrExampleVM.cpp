@@ -62,7 +62,8 @@ rootTableHashEqualFn(void *leftEntry, void *rightEntry, void *userData)
 }
 
 /**
- * Hash table callback for retrieving hash value of an entry
+ * Hash table callback for retrieving hash value of an entry. Entries without a name
+ * (heap debugging entries of the VM) are keyed by their object address.
  *
  * @param[in] entry Entry to hash
  * @param[in] userData Data that can be passed along, unused in this callback
@@ -71,6 +72,9 @@ uintptr_t
 objectTableHashFn(void *entry, void *userData)
 {
 	const char *name = ((ObjectEntry *)entry)->name;
+	if (NULL == name) {
+		return ((uintptr_t)((ObjectEntry *)entry)->objPtr) >> 3;
+	}
 	uintptr_t length = strlen(name);
 	uintptr_t hash = 0;
 	uintptr_t i;
@@ -90,7 +94,7 @@ objectTableHashFn(void *entry, void *userData)
  * @param[in] userData Data that can be passed along, unused in this callback
  *
  * @return True if the entries are deemed equal, that is if the string representation of their
- * keys are identical.
+ * keys are identical, or for unnamed entries if they refer to the same object.
  *
  */
 uintptr_t
@@ -98,6 +102,9 @@ objectTableHashEqualFn(void *leftEntry, void *rightEntry, void *userData)
 {
 	ObjectEntry *loe = (ObjectEntry *)leftEntry;
 	ObjectEntry *roe = (ObjectEntry *)rightEntry;
+	if ((NULL == loe->name) || (NULL == roe->name)) {
+		return (loe->name == roe->name) && (loe->objPtr == roe->objPtr);
+	}
 	return (0 == strcmp(loe->name, roe->name));
 }
 
@@ -28,14 +28,23 @@ THE SOFTWARE.
 #include "Interpreter.h"
 #include "bytecodes.h"
 
+#include <new>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+#include <string.h>
+
 #include "../vmobjects/VMMethod.h"
 #include "../vmobjects/VMFrame.h"
 #include "../vmobjects/VMMethod.h"
 #include "../vmobjects/VMClass.h"
 #include "../vmobjects/VMObject.h"
 #include "../vmobjects/VMSymbol.h"
+#include "../vmobjects/VMArray.h"
+#include "../vmobjects/VMBlock.h"
 #include "../vmobjects/VMInvokable.h"
 #include "../vmobjects/Signature.h"
+#include "../vmobjects/InlineCache.h"
 
 #include "../compiler/Disassembler.h"
 
@@ -46,9 +55,30 @@ THE SOFTWARE.
 #define _METHOD this->GetMethod()
 #define _SELF this->GetSelf()
 
+// The direct-threaded interpreter loop needs the "labels as values" extension
+// of GCC and Clang. Compile with -DUSE_SWITCH_DISPATCH to force the portable
+// switch-based loop instead.
+#if defined(__GNUC__) && !defined(USE_SWITCH_DISPATCH)
+#define USE_THREADED_DISPATCH
+#endif
+
+// size of the native frame stack, deeper recursion continues with heap frames
+#define FRAME_STACK_SIZE (1024 * 1024)
+
 
 Interpreter::Interpreter() {
     this->frame = NULL;
+    this->primitiveFrame = NULL;
+    this->primitiveStackPointer = -1;
+    this->restartIndex = 0;
+    this->frameStack = new char[FRAME_STACK_SIZE];
+    this->frameStackTop = this->frameStack;
+    this->frameStackEnd = this->frameStack + FRAME_STACK_SIZE;
+
+    this->pairCounts = NULL;
+    this->tripleCounts = NULL;
+    this->bytecodeCount = 0;
+    this->profiledFrame = NULL;
     
     uG = "unknownGlobal:";
     dnu = "doesNotUnderstand:arguments:";
@@ -58,12 +88,51 @@ Interpreter::Interpreter() {
 
 
 Interpreter::~Interpreter() {
-    
+    delete[] frameStack;
+    delete[] pairCounts;
+    delete[] tripleCounts;
 }
 
 
 void Interpreter::Start() {
+    // Only the loops can restart a bytecode whose allocation failed. They are
+    // left for it and entered again, starting with a safepoint.
+    Heap::AllowRetry(true);
+    while (true) {
+        try {
+#ifdef USE_THREADED_DISPATCH
+            // bytecode tracing and profiling are handled by the switch loop
+            // only, keeping the threaded loop free of the per-bytecode check
+            if (dumpBytecodes > 1 || profileBytecodes)
+                this->startSwitch();
+            else
+                this->startThreaded();
+#else
+            this->startSwitch();
+#endif
+            break;
+        } catch (Heap::AllocationRetry&) {
+            this->restartBytecode();
+        }
+    }
+    Heap::AllowRetry(false);
+}
+
+
+void Interpreter::restartBytecode() {
+    // The bytecode changed nothing but the stack pointer of the frame it runs
+    // in, which a primitive resets as it unwinds, and maybe that frame was
+    // replaced by a copy on the heap. It runs again after the safepoint.
+    _HEAP->AbandonAllocations();
+    _FRAME->SetBytecodeIndex(restartIndex);
+}
+
+
+void Interpreter::startSwitch() {
     while (true) {
+        // nothing is kept across bytecodes, so each one starts at a safepoint
+        Heap::Safepoint();
+
         int bytecodeIndex = _FRAME->GetBytecodeIndex();
 
         pVMMethod method = this->GetMethod();
@@ -73,11 +142,16 @@ void Interpreter::Start() {
 
         if(dumpBytecodes >1)
             Disassembler::DumpBytecode(_FRAME, method, bytecodeIndex);
+        if(profileBytecodes)
+            this->profileBytecode(bytecodeIndex, bytecode);
 
         int nextBytecodeIndex = bytecodeIndex + bytecodeLength;
 
         _FRAME->SetBytecodeIndex(nextBytecodeIndex);
 
+        // a superinstruction is restarted at the send following its push
+        restartIndex = bytecodeIndex;
+
 // Handle the current bytecode
         switch(bytecode) {
             case BC_HALT:             return; // handle the halt bytecode
@@ -96,6 +170,72 @@ void Interpreter::Start() {
             case BC_SUPER_SEND:       doSuperSend(bytecodeIndex); break;
             case BC_RETURN_LOCAL:     doReturnLocal(); break;
             case BC_RETURN_NON_LOCAL: doReturnNonLocal(); break;
+            case BC_JUMP:             doJump(bytecodeIndex); break;
+            case BC_JUMP_IF_TRUE:     doJumpIf(bytecodeIndex,
+                                               trueObject); break;
+            case BC_JUMP_IF_FALSE:    doJumpIf(bytecodeIndex,
+                                               falseObject); break;
+            case BC_JUMP_BACKWARD:    doJumpBackward(bytecodeIndex); break;
+            case BC_SEND_PLUS:
+            case BC_SEND_MINUS:
+            case BC_SEND_STAR:
+            case BC_SEND_LESS:
+            case BC_SEND_MORE:
+            case BC_SEND_LESS_EQUAL:
+            case BC_SEND_MORE_EQUAL:
+            case BC_SEND_EQUAL:
+            case BC_SEND_IDENTICAL:
+            case BC_SEND_AT:
+            case BC_SEND_AT_PUT:
+            case BC_SEND_LENGTH:
+            case BC_SEND_VALUE:
+            case BC_SEND_VALUE_ARG:   if(!doSpecialSend(bytecode))
+                                          doSend(bytecodeIndex);
+                                      break;
+            case BC_RETURN_SELF:      doReturnSelf(); break;
+            case BC_RETURN_FIELD:     doReturnField(bytecodeIndex); break;
+            case BC_RETURN_CONSTANT:  doReturnConstant(bytecodeIndex); break;
+            // a superinstruction executes both bytecodes of its sequence
+            case BC_PUSH_LOCAL_CONSTANT:
+                doPushLocal(bytecodeIndex);
+                doPushConstant(bytecodeIndex + 3);
+                break;
+            case BC_PUSH_ARGUMENT_ARGUMENT:
+                doPushArgument(bytecodeIndex);
+                doPushArgument(bytecodeIndex + 3);
+                break;
+            case BC_PUSH_ARGUMENT_LOCAL:
+                doPushArgument(bytecodeIndex);
+                doPushLocal(bytecodeIndex + 3);
+                break;
+            case BC_POP_PUSH_LOCAL:
+                doPop();
+                doPushLocal(bytecodeIndex + 1);
+                break;
+            case BC_PUSH_ARGUMENT_SEND:
+                doPushArgument(bytecodeIndex);
+                restartIndex = bytecodeIndex + 3;
+                doSend(bytecodeIndex + 3);
+                break;
+            case BC_PUSH_CONSTANT_SEND_PLUS:
+                doPushConstant(bytecodeIndex);
+                restartIndex = bytecodeIndex + 2;
+                if(!doSpecialSend(BC_SEND_PLUS))
+                    doSend(bytecodeIndex + 2);
+                break;
+            case BC_LESS_EQUAL_JUMP_IF_FALSE:
+                if(doSpecialSend(BC_SEND_LESS_EQUAL))
+                    doJumpIf(bytecodeIndex + 4, falseObject);
+                else {
+                    // the jump tests the result of the send
+                    _FRAME->SetBytecodeIndex(bytecodeIndex + 4);
+                    doSend(bytecodeIndex);
+                }
+                break;
+            case BC_PUSH_FIELD_RETURN_LOCAL:
+                doPushField(bytecodeIndex);
+                doReturnLocal();
+                break;
             default:                  _UNIVERSE->ErrorExit(
                                            "Interpreter: Unexpected bytecode"); 
         } // switch
@@ -103,9 +243,447 @@ void Interpreter::Start() {
 }
 
 
+void Interpreter::startThreaded() {
+#ifdef USE_THREADED_DISPATCH
+    // one label per bytecode, indexed by the bytecode value
+    static void* const dispatchTable[] = {
+        &&LABEL_BC_HALT,
+        &&LABEL_BC_DUP,
+        &&LABEL_BC_PUSH_LOCAL,
+        &&LABEL_BC_PUSH_ARGUMENT,
+        &&LABEL_BC_PUSH_FIELD,
+        &&LABEL_BC_PUSH_BLOCK,
+        &&LABEL_BC_PUSH_CONSTANT,
+        &&LABEL_BC_PUSH_GLOBAL,
+        &&LABEL_BC_POP,
+        &&LABEL_BC_POP_LOCAL,
+        &&LABEL_BC_POP_ARGUMENT,
+        &&LABEL_BC_POP_FIELD,
+        &&LABEL_BC_SEND,
+        &&LABEL_BC_SUPER_SEND,
+        &&LABEL_BC_RETURN_LOCAL,
+        &&LABEL_BC_RETURN_NON_LOCAL,
+        &&LABEL_BC_JUMP,
+        &&LABEL_BC_JUMP_IF_TRUE,
+        &&LABEL_BC_JUMP_IF_FALSE,
+        &&LABEL_BC_JUMP_BACKWARD,
+        &&LABEL_BC_SEND_PLUS,
+        &&LABEL_BC_SEND_MINUS,
+        &&LABEL_BC_SEND_STAR,
+        &&LABEL_BC_SEND_LESS,
+        &&LABEL_BC_SEND_MORE,
+        &&LABEL_BC_SEND_LESS_EQUAL,
+        &&LABEL_BC_SEND_MORE_EQUAL,
+        &&LABEL_BC_SEND_EQUAL,
+        &&LABEL_BC_SEND_IDENTICAL,
+        &&LABEL_BC_SEND_AT,
+        &&LABEL_BC_SEND_AT_PUT,
+        &&LABEL_BC_SEND_LENGTH,
+        &&LABEL_BC_SEND_VALUE,
+        &&LABEL_BC_SEND_VALUE_ARG,
+        &&LABEL_BC_RETURN_SELF,
+        &&LABEL_BC_RETURN_FIELD,
+        &&LABEL_BC_RETURN_CONSTANT,
+        &&LABEL_BC_PUSH_LOCAL_CONSTANT,
+        &&LABEL_BC_PUSH_ARGUMENT_ARGUMENT,
+        &&LABEL_BC_PUSH_ARGUMENT_LOCAL,
+        &&LABEL_BC_POP_PUSH_LOCAL,
+        &&LABEL_BC_PUSH_ARGUMENT_SEND,
+        &&LABEL_BC_PUSH_CONSTANT_SEND_PLUS,
+        &&LABEL_BC_LESS_EQUAL_JUMP_IF_FALSE,
+        &&LABEL_BC_PUSH_FIELD_RETURN_LOCAL
+    };
+
+    // The current frame, its bytecodes and the index of the bytecode being
+    // executed are kept in locals. The bytecode index is only written back to
+    // the frame before anything that may leave it (sends, returns), and all
+    // three are reloaded afterwards as the frame may have changed. They are
+    // reloaded at a safepoint, where the heap may be compacted. A bytecode
+    // whose allocation failed is restarted from the index it was dispatched
+    // at, which a superinstruction advances to the send following its push.
+    pVMFrame currentFrame;
+    uint8_t* bytecodes;
+    int bytecodeIndex;
+
+#define LOAD_STATE() { \
+    Heap::Safepoint(); \
+    currentFrame = this->GetFrame(); \
+    bytecodes = currentFrame->GetMethod()->GetBytecodes(); \
+    bytecodeIndex = currentFrame->GetBytecodeIndex(); \
+}
+#define SAVE_STATE(next) currentFrame->SetBytecodeIndex(next)
+#define DISPATCH() { \
+    restartIndex = bytecodeIndex; \
+    goto *dispatchTable[bytecodes[bytecodeIndex]]; \
+}
+#define DISPATCH_NEXT(length) { bytecodeIndex += (length); DISPATCH(); }
+// the fast path of a special send stays in the frame, otherwise the message
+// is sent as by BC_SEND
+#define SPECIAL_SEND(bytecode) { \
+    if(doSpecialSend(bytecode)) DISPATCH_NEXT(4); \
+    goto LABEL_BC_SEND; \
+}
+
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_HALT:
+    SAVE_STATE(bytecodeIndex + 1);
+    return;
+
+LABEL_BC_DUP:
+    currentFrame->Push(currentFrame->GetStackElement(0));
+    DISPATCH_NEXT(1);
+
+LABEL_BC_PUSH_LOCAL:
+    currentFrame->Push(currentFrame->GetLocal(bytecodes[bytecodeIndex + 1],
+                                              bytecodes[bytecodeIndex + 2]));
+    DISPATCH_NEXT(3);
+
+LABEL_BC_PUSH_ARGUMENT:
+    currentFrame->Push(currentFrame->GetArgument(bytecodes[bytecodeIndex + 1],
+                                                 bytecodes[bytecodeIndex + 2]));
+    DISPATCH_NEXT(3);
+
+LABEL_BC_PUSH_FIELD:
+    doPushField(bytecodeIndex);
+    DISPATCH_NEXT(2);
+
+LABEL_BC_PUSH_BLOCK:
+    // the block's context is moved to the heap if it isn't there yet
+    SAVE_STATE(bytecodeIndex + 2);
+    doPushBlock(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_PUSH_CONSTANT:
+    doPushConstant(bytecodeIndex);
+    DISPATCH_NEXT(2);
+
+LABEL_BC_PUSH_GLOBAL:
+    // an unknown global is handled by a send
+    SAVE_STATE(bytecodeIndex + 2);
+    doPushGlobal(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_POP:
+    currentFrame->Pop();
+    DISPATCH_NEXT(1);
+
+LABEL_BC_POP_LOCAL:
+    currentFrame->SetLocal(bytecodes[bytecodeIndex + 1],
+                           bytecodes[bytecodeIndex + 2], currentFrame->Pop());
+    DISPATCH_NEXT(3);
+
+LABEL_BC_POP_ARGUMENT:
+    currentFrame->SetArgument(bytecodes[bytecodeIndex + 1],
+                              bytecodes[bytecodeIndex + 2], currentFrame->Pop());
+    DISPATCH_NEXT(3);
+
+LABEL_BC_POP_FIELD:
+    doPopField(bytecodeIndex);
+    DISPATCH_NEXT(2);
+
+LABEL_BC_SEND:
+    SAVE_STATE(bytecodeIndex + 4);
+    doSend(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_SUPER_SEND:
+    SAVE_STATE(bytecodeIndex + 4);
+    doSuperSend(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_RETURN_LOCAL:
+    SAVE_STATE(bytecodeIndex + 1);
+    doReturnLocal();
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_RETURN_NON_LOCAL:
+    SAVE_STATE(bytecodeIndex + 1);
+    doReturnNonLocal();
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_JUMP:
+    bytecodeIndex += Bytecode::GetJumpOffset(bytecodes + bytecodeIndex);
+    DISPATCH();
+
+LABEL_BC_JUMP_IF_TRUE:
+    if(currentFrame->GetStackElement(0) == trueObject) {
+        currentFrame->Pop();
+        bytecodeIndex += Bytecode::GetJumpOffset(bytecodes + bytecodeIndex);
+        DISPATCH();
+    }
+    if(currentFrame->GetStackElement(0) == falseObject) {
+        currentFrame->Pop();
+        DISPATCH_NEXT(4);
+    }
+    sendInlined(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_JUMP_IF_FALSE:
+    if(currentFrame->GetStackElement(0) == falseObject) {
+        currentFrame->Pop();
+        bytecodeIndex += Bytecode::GetJumpOffset(bytecodes + bytecodeIndex);
+        DISPATCH();
+    }
+    if(currentFrame->GetStackElement(0) == trueObject) {
+        currentFrame->Pop();
+        DISPATCH_NEXT(4);
+    }
+    sendInlined(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_JUMP_BACKWARD:
+    // a loop doesn't send anything on its own, so it releases the handles
+    _HEAP->ReleaseHandles();
+    bytecodeIndex -= Bytecode::GetJumpOffset(bytecodes + bytecodeIndex);
+    // neither does it reload the state, unless the heap waits for a safepoint
+    if (Heap::IsSafepointRequested()) {
+        SAVE_STATE(bytecodeIndex);
+        LOAD_STATE();
+    }
+    DISPATCH();
+
+LABEL_BC_SEND_PLUS:        SPECIAL_SEND(BC_SEND_PLUS);
+LABEL_BC_SEND_MINUS:       SPECIAL_SEND(BC_SEND_MINUS);
+LABEL_BC_SEND_STAR:        SPECIAL_SEND(BC_SEND_STAR);
+LABEL_BC_SEND_LESS:        SPECIAL_SEND(BC_SEND_LESS);
+LABEL_BC_SEND_MORE:        SPECIAL_SEND(BC_SEND_MORE);
+LABEL_BC_SEND_LESS_EQUAL:  SPECIAL_SEND(BC_SEND_LESS_EQUAL);
+LABEL_BC_SEND_MORE_EQUAL:  SPECIAL_SEND(BC_SEND_MORE_EQUAL);
+LABEL_BC_SEND_EQUAL:       SPECIAL_SEND(BC_SEND_EQUAL);
+LABEL_BC_SEND_IDENTICAL:   SPECIAL_SEND(BC_SEND_IDENTICAL);
+LABEL_BC_SEND_AT:          SPECIAL_SEND(BC_SEND_AT);
+LABEL_BC_SEND_AT_PUT:      SPECIAL_SEND(BC_SEND_AT_PUT);
+LABEL_BC_SEND_LENGTH:      SPECIAL_SEND(BC_SEND_LENGTH);
+
+LABEL_BC_SEND_VALUE:
+    // evaluating a block enters a new frame
+    SAVE_STATE(bytecodeIndex + 4);
+    if(doSpecialSend(BC_SEND_VALUE)) { LOAD_STATE(); DISPATCH(); }
+    goto LABEL_BC_SEND;
+
+LABEL_BC_SEND_VALUE_ARG:
+    SAVE_STATE(bytecodeIndex + 4);
+    if(doSpecialSend(BC_SEND_VALUE_ARG)) { LOAD_STATE(); DISPATCH(); }
+    goto LABEL_BC_SEND;
+
+LABEL_BC_RETURN_SELF:
+    SAVE_STATE(bytecodeIndex + 1);
+    doReturnSelf();
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_RETURN_FIELD:
+    SAVE_STATE(bytecodeIndex + 2);
+    doReturnField(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+LABEL_BC_RETURN_CONSTANT:
+    SAVE_STATE(bytecodeIndex + 2);
+    doReturnConstant(bytecodeIndex);
+    LOAD_STATE();
+    DISPATCH();
+
+// a superinstruction continues with the second bytecode of its sequence
+// where that would need a dispatch of its own
+LABEL_BC_PUSH_LOCAL_CONSTANT:
+    currentFrame->Push(currentFrame->GetLocal(bytecodes[bytecodeIndex + 1],
+                                              bytecodes[bytecodeIndex + 2]));
+    currentFrame->Push(currentFrame->GetMethod()->GetConstant(
+                                                        bytecodeIndex + 3));
+    DISPATCH_NEXT(5);
+
+LABEL_BC_PUSH_ARGUMENT_ARGUMENT:
+    currentFrame->Push(currentFrame->GetArgument(bytecodes[bytecodeIndex + 1],
+                                                 bytecodes[bytecodeIndex + 2]));
+    currentFrame->Push(currentFrame->GetArgument(bytecodes[bytecodeIndex + 4],
+                                                 bytecodes[bytecodeIndex + 5]));
+    DISPATCH_NEXT(6);
+
+LABEL_BC_PUSH_ARGUMENT_LOCAL:
+    currentFrame->Push(currentFrame->GetArgument(bytecodes[bytecodeIndex + 1],
+                                                 bytecodes[bytecodeIndex + 2]));
+    currentFrame->Push(currentFrame->GetLocal(bytecodes[bytecodeIndex + 4],
+                                              bytecodes[bytecodeIndex + 5]));
+    DISPATCH_NEXT(6);
+
+LABEL_BC_POP_PUSH_LOCAL:
+    currentFrame->Pop();
+    currentFrame->Push(currentFrame->GetLocal(bytecodes[bytecodeIndex + 2],
+                                              bytecodes[bytecodeIndex + 3]));
+    DISPATCH_NEXT(4);
+
+LABEL_BC_PUSH_ARGUMENT_SEND:
+    currentFrame->Push(currentFrame->GetArgument(bytecodes[bytecodeIndex + 1],
+                                                 bytecodes[bytecodeIndex + 2]));
+    bytecodeIndex += 3;
+    restartIndex = bytecodeIndex;
+    goto LABEL_BC_SEND;
+
+LABEL_BC_PUSH_CONSTANT_SEND_PLUS:
+    doPushConstant(bytecodeIndex);
+    bytecodeIndex += 2;
+    restartIndex = bytecodeIndex;
+    SPECIAL_SEND(BC_SEND_PLUS);
+
+LABEL_BC_LESS_EQUAL_JUMP_IF_FALSE: {
+    pVMObject right = currentFrame->GetStackElement(0);
+    pVMObject left = currentFrame->GetStackElement(1);
+    if (IS_TAGGED(left) && IS_TAGGED(right)) {
+        currentFrame->Pop();
+        currentFrame->Pop();
+        if (UNTAG_INTEGER(left) <= UNTAG_INTEGER(right)) DISPATCH_NEXT(8);
+        bytecodeIndex += 4;
+        bytecodeIndex += Bytecode::GetJumpOffset(bytecodes + bytecodeIndex);
+        DISPATCH();
+    }
+    // the jump tests the result of the send
+    goto LABEL_BC_SEND;
+}
+
+LABEL_BC_PUSH_FIELD_RETURN_LOCAL:
+    doPushField(bytecodeIndex);
+    SAVE_STATE(bytecodeIndex + 3);
+    doReturnLocal();
+    LOAD_STATE();
+    DISPATCH();
+
+#undef LOAD_STATE
+#undef SAVE_STATE
+#undef DISPATCH
+#undef DISPATCH_NEXT
+#undef SPECIAL_SEND
+#else
+    _UNIVERSE->ErrorExit("Interpreter: threaded dispatch not available");
+#endif
+}
+
+
+void Interpreter::profileBytecode( int bytecodeIndex, uint8_t bytecode ) {
+    if (pairCounts == NULL) {
+        pairCounts = new uint64_t[NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES];
+        tripleCounts = new uint64_t[NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES *
+                                    NUMBER_OF_BYTECODES];
+        memset(pairCounts, 0, NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES *
+                              sizeof(uint64_t));
+        memset(tripleCounts, 0, NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES *
+                                NUMBER_OF_BYTECODES * sizeof(uint64_t));
+    }
+    ++bytecodeCount;
+
+    //only bytecodes following each other in the same method form a
+    //sequence, a superinstruction can't span a send or a jump
+    if (_FRAME != profiledFrame || bytecodeIndex != profiledNextIndex) {
+        profiledPrevious[0] = profiledPrevious[1] = -1;
+    }
+    if (profiledPrevious[1] >= 0) {
+        ++pairCounts[profiledPrevious[1] * NUMBER_OF_BYTECODES + bytecode];
+        if (profiledPrevious[0] >= 0)
+            ++tripleCounts[(profiledPrevious[0] * NUMBER_OF_BYTECODES + 
+                            profiledPrevious[1]) * NUMBER_OF_BYTECODES +
+                           bytecode];
+    }
+    profiledPrevious[0] = profiledPrevious[1];
+    profiledPrevious[1] = bytecode;
+    profiledFrame = _FRAME;
+    profiledNextIndex = bytecodeIndex + Bytecode::GetBytecodeLength(bytecode);
+}
+
+
+//prints the most frequent entries of counts, which has size entries for
+//sequences of length bytecodes
+static void printMostFrequent( const uint64_t* counts, int size, int length,
+                               uint64_t total ) {
+    vector<pair<uint64_t, int> > sorted;
+    for (int i = 0; i < size; ++i)
+        if (counts[i] > 0) sorted.push_back(make_pair(counts[i], i));
+    sort(sorted.rbegin(), sorted.rend());
+
+    for (size_t i = 0; i < sorted.size() && i < 20; ++i) {
+        cout << "  " << setw(12) << sorted[i].first << "  " << fixed
+             << setprecision(2) << setw(5)
+             << 100.0 * sorted[i].first / total << "%  ";
+        int sequence = sorted[i].second;
+        int divisor = length == 3 ? NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES
+                                  : NUMBER_OF_BYTECODES;
+        for (int j = 0; j < length; ++j) {
+            cout << Bytecode::GetBytecodeName(sequence / divisor) << " ";
+            sequence %= divisor;
+            divisor /= NUMBER_OF_BYTECODES;
+        }
+        cout << endl;
+    }
+}
+
+
+void Interpreter::PrintBytecodeProfile() {
+    if (pairCounts == NULL) return;
+
+    cout << "Bytecodes executed: " << bytecodeCount << endl;
+    cout << "Most frequent pairs:" << endl;
+    printMostFrequent(pairCounts, NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES,
+                      2, bytecodeCount);
+    cout << "Most frequent triples:" << endl;
+    printMostFrequent(tripleCounts, NUMBER_OF_BYTECODES * NUMBER_OF_BYTECODES *
+                      NUMBER_OF_BYTECODES, 3, bytecodeCount);
+}
+
+
 pVMFrame Interpreter::PushNewFrame( pVMMethod method ) {
-    _SETFRAME(_UNIVERSE->NewFrame(_FRAME, method));
-    return _FRAME;
+    int length = method->GetNumberOfArguments() +
+                 method->GetNumberOfLocals() +
+                 method->GetMaximumNumberOfStackElements();
+    size_t size = sizeof(VMFrame) + length * sizeof(pVMObject);
+    int32_t offset = frameStackTop - frameStack;
+
+    pVMFrame result;
+    if (size <= (size_t)(frameStackEnd - frameStackTop)) {
+        //as with the heap, the size is known before the array is constructed
+        ((pVMObject)frameStackTop)->SetObjectSize(size);
+        result = ::new (frameStackTop) VMFrame(length);
+        frameStackTop += size;
+
+        result->SetClass(frameClass);
+        result->SetMethod(method);
+        if (_FRAME != NULL) result->SetPreviousFrame(_FRAME);
+        result->ResetStackPointer();
+        result->SetBytecodeIndex(0);
+    } else
+        result = _UNIVERSE->NewFrame(_FRAME, method);
+
+    result->SetNativeStackOffset(offset);
+    _SETFRAME(result);
+    return result;
+}
+
+
+bool Interpreter::IsNativeFrame( pVMFrame frame ) const {
+    return (char*)frame >= frameStack && (char*)frame < frameStackEnd;
+}
+
+
+pVMFrame Interpreter::ReifyFrame( pVMFrame frame ) {
+    if (!this->IsNativeFrame(frame)) return frame;
+
+    //a copy on the heap takes the place of the frame in the chain, its space
+    //on the native stack is given back once the copy is popped
+    pVMFrame reified = VMFrame::EmergencyFrameFrom(frame, 0);
+
+    pVMObject* slot = (pVMObject*)&this->frame;
+    while (*slot != frame) slot = ((pVMFrame)*slot)->GetPreviousFrameSlot();
+    *slot = reified;
+
+    return reified;
 }
 
 
@@ -119,6 +697,27 @@ pVMFrame Interpreter::GetFrame() {
 }
 
 
+void Interpreter::SetPrimitiveFrame( pVMFrame frame, int32_t stackPointer ) {
+    this->primitiveFrame = frame;
+    this->primitiveStackPointer = stackPointer;
+}
+
+
+void Interpreter::WalkFrames( RootWalker walk, void* data ) {
+    //a frame on the heap is reached through the slot referring to it, while
+    //the GC doesn't know the frames on the native stack: their objects are
+    //roots themselves. The contexts of blocks are always on the heap.
+    pVMObject* slot = (pVMObject*)&this->frame;
+    while (*slot != NULL && *slot != nilObject) {
+        if (this->IsNativeFrame((pVMFrame)*slot))
+            ((pVMFrame)*slot)->WalkObjects(walk, data);
+        else
+            walk(slot, data);
+        slot = ((pVMFrame)*slot)->GetPreviousFrameSlot();
+    }
+}
+
+
 pVMMethod Interpreter::GetMethod() {
     pVMMethod method = _FRAME->GetMethod();
    /* cout << "bytecodes: ";
@@ -132,8 +731,7 @@ pVMMethod Interpreter::GetMethod() {
 
 
 pVMObject Interpreter::GetSelf() {
-    pVMFrame context = _FRAME->GetOuterContext();
-    return context->GetArgument(0,0);
+    return _FRAME->GetReceiver();
 }
 
 
@@ -142,6 +740,7 @@ pVMFrame Interpreter::popFrame() {
     this->SetFrame(_FRAME->GetPreviousFrame());
 
     result->ClearPreviousFrame();
+    frameStackTop = frameStack + result->GetNativeStackOffset();
 
     return result;
 }
@@ -159,14 +758,28 @@ void Interpreter::popFrameAndPushResult( pVMObject result ) {
 }
 
 
-void Interpreter::send( pVMSymbol signature, pVMClass receiverClass) {
-    pVMInvokable invokable = 
-                dynamic_cast<pVMInvokable>( receiverClass->LookupInvokable(signature) );
+void Interpreter::send( pVMSymbol signature, pVMClass receiverClass,
+                        InlineCache* cache ) {
+    //between two sends all live objects are reachable from the frames
+    _HEAP->ReleaseHandles();
+
+    pVMInvokable invokable = NULL;
+
+    if (cache != NULL) invokable = cache->Lookup(receiverClass);
+
+    if (invokable == NULL) {
+        invokable = dynamic_cast<pVMInvokable>( 
+                                receiverClass->LookupInvokable(signature) );
+        if (invokable != NULL && cache != NULL) 
+            cache->Update(receiverClass, invokable);
+    }
 
     if (invokable != NULL) {
         (*invokable)(_FRAME);
     } else {
-        //doesNotUnderstand
+        //doesNotUnderstand, the frame may be copied after the arguments
+        //are popped
+        Heap::PreventRetry();
         int numberOfArgs = Signature::GetNumberOfArguments(signature);
 
         pVMObject receiver = _FRAME->GetStackElement(numberOfArgs-1);
@@ -175,7 +788,7 @@ void Interpreter::send( pVMSymbol signature, pVMClass receiverClass) {
 
         for (int i = numberOfArgs - 1; i >= 0; --i) {
             pVMObject o = _FRAME->Pop();
-            (*argumentsArray)[i] = o; 
+            argumentsArray->SetIndexableField(i, o);
         }
         pVMObject arguments[] = { (pVMObject)signature, 
                                   (pVMObject)argumentsArray };
@@ -188,7 +801,7 @@ void Interpreter::send( pVMSymbol signature, pVMClass receiverClass) {
             this->SetFrame(VMFrame::EmergencyFrameFrom(_FRAME, additionalStackSlots));
         }
 
-        receiver->Send(dnu, arguments, 2);
+        VMObject::Send(receiver, dnu, arguments, 2);
     }
 }
 
@@ -224,12 +837,17 @@ void Interpreter::doPushArgument( int bytecodeIndex ) {
 void Interpreter::doPushField( int bytecodeIndex ) {
     pVMMethod method = _METHOD;
 
-    pVMSymbol fieldName = (pVMSymbol) method->GetConstant(bytecodeIndex);
+    // the compiler has already resolved the field to its slot
+    uint8_t fieldIndex = method->GetBytecode(bytecodeIndex + 1);
 
     pVMObject self = _SELF;
-    int fieldIndex = self->GetFieldIndex(fieldName);
-
-    pVMObject o = self->GetField(fieldIndex);
+    pVMObject o;
+    if (IS_TAGGED(self)) {
+        // the only field of an integer is its class
+        o = (pVMObject)integerClass;
+    } else {
+        o = self->GetField(fieldIndex);
+    }
 
     _FRAME->Push(o);
 }
@@ -243,8 +861,9 @@ void Interpreter::doPushBlock( int bytecodeIndex ) {
     pVMMethod blockMethod = (pVMMethod)(po);
     int numOfArgs = blockMethod->GetNumberOfArguments();
 
-    _FRAME->Push((pVMObject) _UNIVERSE->NewBlock(blockMethod, _FRAME,
-                                                 numOfArgs));
+    //creating the block may move the frame to the heap
+    pVMBlock block = _UNIVERSE->NewBlock(blockMethod, _FRAME, numOfArgs);
+    _FRAME->Push((pVMObject) block);
 }
 
 
@@ -261,14 +880,15 @@ void Interpreter::doPushGlobal( int bytecodeIndex) {
 
     pVMMethod method = _METHOD;
 
-    pVMSymbol globalName = (pVMSymbol) method->GetConstant(bytecodeIndex);
+    pVMObject* association = 
+        ((pVMArray)method->GetConstant(bytecodeIndex))->GetStartOfAdditionalPoint();
 
-    pVMObject global = _UNIVERSE->GetGlobal(globalName);
+    pVMObject global = association[ASSOCIATION_VALUE];
 
     if(global != NULL)
         _FRAME->Push(global);
     else {
-        pVMObject arguments[] = { (pVMObject) globalName };
+        pVMObject arguments[] = { association[ASSOCIATION_KEY] };
         pVMObject self = _SELF;
 
         //check if there is enough space on the stack for this unplanned Send
@@ -280,7 +900,7 @@ void Interpreter::doPushGlobal( int bytecodeIndex) {
                            additionalStackSlots));
         }
 
-        self->Send(uG, arguments, 1);
+        VMObject::Send(self, uG, arguments, 1);
     }
 }
 
@@ -314,10 +934,9 @@ void Interpreter::doPopArgument( int bytecodeIndex ) {
 
 void Interpreter::doPopField( int bytecodeIndex ) {
     pVMMethod method = _METHOD;
-    pVMSymbol field_name = (pVMSymbol) method->GetConstant(bytecodeIndex);
+    uint8_t field_index = method->GetBytecode(bytecodeIndex + 1);
 
     pVMObject self = _SELF;
-    int field_index = self->GetFieldIndex(field_name);
 
     pVMObject o = _FRAME->Pop();
     self->SetField(field_index, o);
@@ -329,11 +948,12 @@ void Interpreter::doSend( int bytecodeIndex ) {
     
     pVMSymbol signature = (pVMSymbol) method->GetConstant(bytecodeIndex);
 
-    int numOfArgs = Signature::GetNumberOfArguments(signature);
+    int numOfArgs = method->GetBytecode(bytecodeIndex + 3);
 
     pVMObject receiver = _FRAME->GetStackElement(numOfArgs-1);
 
-    this->send(signature, receiver->GetClass());
+    this->send(signature, CLASS_OF(receiver), 
+               method->GetInlineCache(bytecodeIndex));
 }
 
 
@@ -345,22 +965,35 @@ void Interpreter::doSuperSend( int bytecodeIndex ) {
     pVMMethod realMethod = ctxt->GetMethod();
     pVMClass holder = realMethod->GetHolder();
     pVMClass super = holder->GetSuperClass();
-    pVMInvokable invokable = dynamic_cast<pVMInvokable>( super->LookupInvokable(signature) );
+
+    _HEAP->ReleaseHandles();
+
+    // the lookup class of a super send never changes, so the inline cache
+    // of the site stays monomorphic
+    InlineCache* cache = method->GetInlineCache(bytecodeIndex);
+    pVMInvokable invokable = NULL;
+    if (cache != NULL) invokable = cache->Lookup(super);
+    if (invokable == NULL) {
+        invokable = dynamic_cast<pVMInvokable>( super->LookupInvokable(signature) );
+        if (invokable != NULL && cache != NULL) 
+            cache->Update(super, invokable);
+    }
 
     if (invokable != NULL)
         (*invokable)(_FRAME);
     else {
+        Heap::PreventRetry();
         int numOfArgs = Signature::GetNumberOfArguments(signature);
         pVMObject receiver = _FRAME->GetStackElement(numOfArgs - 1);
         pVMArray argumentsArray = _UNIVERSE->NewArray(numOfArgs);
 
         for (int i = numOfArgs - 1; i >= 0; --i) {
             pVMObject o = _FRAME->Pop();
-            (*argumentsArray)[i] = o; 
+            argumentsArray->SetIndexableField(i, o);
         }
         pVMObject arguments[] = { (pVMObject)signature, 
                                   (pVMObject) argumentsArray };
-        receiver->Send(dnu, arguments, 2);
+        VMObject::Send(receiver, dnu, arguments, 2);
     }
 }
 
@@ -372,12 +1005,36 @@ void Interpreter::doReturnLocal() {
 }
 
 
+void Interpreter::doReturnSelf() {
+    this->popFrameAndPushResult(_FRAME->GetArgument(0, 0));
+}
+
+
+void Interpreter::doReturnField( int bytecodeIndex ) {
+    uint8_t fieldIndex = _METHOD->GetBytecode(bytecodeIndex + 1);
+
+    pVMObject self = _SELF;
+    pVMObject o = IS_TAGGED(self) ? (pVMObject)integerClass
+                                  : self->GetField(fieldIndex);
+
+    this->popFrameAndPushResult(o);
+}
+
+
+void Interpreter::doReturnConstant( int bytecodeIndex ) {
+    pVMObject constant = _METHOD->GetConstant(bytecodeIndex);
+
+    this->popFrameAndPushResult(constant);
+}
+
+
 void Interpreter::doReturnNonLocal() {
     pVMObject result = _FRAME->Pop();
 
     pVMFrame context = _FRAME->GetOuterContext();
 
     if (!context->HasPreviousFrame()) {
+        Heap::PreventRetry();
         pVMBlock block = (pVMBlock) _FRAME->GetArgument(0, 0);
         pVMFrame prevFrame = _FRAME->GetPreviousFrame();
         pVMFrame outerContext = prevFrame->GetOuterContext();
@@ -386,7 +1043,7 @@ void Interpreter::doReturnNonLocal() {
 
         this->popFrame();
 
-        sender->Send(eB, arguments, 1);
+        VMObject::Send(sender, eB, arguments, 1);
         return;
     }
 
@@ -395,3 +1052,204 @@ void Interpreter::doReturnNonLocal() {
     this->popFrameAndPushResult(result);
 }
 
+
+bool Interpreter::doSpecialSend( uint8_t bytecode ) {
+    //the primitives of the special selectors, for tagged integers, arrays and
+    //blocks; anything else is left to a send
+    pVMFrame frame = _FRAME;
+
+    switch (bytecode) {
+        case BC_SEND_PLUS:
+        case BC_SEND_MINUS:
+        case BC_SEND_STAR: {
+            pVMObject right = frame->GetStackElement(0);
+            pVMObject left = frame->GetStackElement(1);
+            if (!IS_TAGGED(left) || !IS_TAGGED(right)) return false;
+
+            int64_t result;
+            if (bytecode == BC_SEND_PLUS)
+                result = (int64_t)UNTAG_INTEGER(left) + UNTAG_INTEGER(right);
+            else if (bytecode == BC_SEND_MINUS)
+                result = (int64_t)UNTAG_INTEGER(left) - UNTAG_INTEGER(right);
+            else
+                result = (int64_t)UNTAG_INTEGER(left) * UNTAG_INTEGER(right);
+            //Integers have 32 bits, the primitive turns larger results into
+            //BigIntegers and boxes those outside of the tagged range
+            if (result < INT32_MIN || result > INT32_MAX ||
+                !CAN_TAG_INTEGER(result))
+                return false;
+
+            frame->Pop();
+            frame->SetStackElement(0, (pVMObject)TAG_INTEGER(result));
+            return true;
+        }
+        case BC_SEND_LESS:
+        case BC_SEND_MORE:
+        case BC_SEND_LESS_EQUAL:
+        case BC_SEND_MORE_EQUAL:
+        case BC_SEND_EQUAL: {
+            pVMObject right = frame->GetStackElement(0);
+            pVMObject left = frame->GetStackElement(1);
+            if (!IS_TAGGED(left) || !IS_TAGGED(right)) return false;
+
+            int32_t l = UNTAG_INTEGER(left);
+            int32_t r = UNTAG_INTEGER(right);
+            bool result;
+            switch (bytecode) {
+                case BC_SEND_LESS:       result = l < r;  break;
+                case BC_SEND_MORE:       result = l > r;  break;
+                case BC_SEND_LESS_EQUAL: result = l <= r; break;
+                case BC_SEND_MORE_EQUAL: result = l >= r; break;
+                default:                 result = l == r; break;
+            }
+
+            frame->Pop();
+            frame->SetStackElement(0, result ? trueObject : falseObject);
+            return true;
+        }
+        case BC_SEND_IDENTICAL: {
+            pVMObject right = frame->Pop();
+            pVMObject left = frame->GetStackElement(0);
+            frame->SetStackElement(0, left == right ? trueObject : falseObject);
+            return true;
+        }
+        case BC_SEND_AT: {
+            pVMObject index = frame->GetStackElement(0);
+            pVMObject receiver = frame->GetStackElement(1);
+            if (IS_TAGGED(receiver) || receiver->GetClass() != arrayClass ||
+                !IS_TAGGED(index))
+                return false;
+
+            pVMArray array = (pVMArray)receiver;
+            int i = UNTAG_INTEGER(index);
+            if (i < 1 || i > array->GetNumberOfIndexableFields()) return false;
+
+            frame->Pop();
+            frame->SetStackElement(0, (*array)[i - 1]);
+            return true;
+        }
+        case BC_SEND_AT_PUT: {
+            pVMObject index = frame->GetStackElement(1);
+            pVMObject receiver = frame->GetStackElement(2);
+            if (IS_TAGGED(receiver) || receiver->GetClass() != arrayClass ||
+                !IS_TAGGED(index))
+                return false;
+
+            pVMArray array = (pVMArray)receiver;
+            int i = UNTAG_INTEGER(index);
+            if (i < 1 || i > array->GetNumberOfIndexableFields()) return false;
+
+            //at:put: answers the array, which stays on the stack
+            array->SetIndexableField(i - 1, frame->Pop());
+            frame->Pop();
+            return true;
+        }
+        case BC_SEND_LENGTH: {
+            pVMObject receiver = frame->GetStackElement(0);
+            if (IS_TAGGED(receiver) || receiver->GetClass() != arrayClass)
+                return false;
+
+            int length = ((pVMArray)receiver)->GetNumberOfIndexableFields();
+            frame->SetStackElement(0, (pVMObject)TAG_INTEGER(length));
+            return true;
+        }
+        case BC_SEND_VALUE:
+        case BC_SEND_VALUE_ARG: {
+            //the block itself is the first argument of its method, whose
+            //number of arguments the class of the block stands for
+            int numOfArgs = bytecode == BC_SEND_VALUE ? 1 : 2;
+            pVMClass expected = bytecode == BC_SEND_VALUE ? block1Class
+                                                          : block2Class;
+            pVMObject receiver = frame->GetStackElement(numOfArgs - 1);
+            if (IS_TAGGED(receiver) || receiver->GetClass() != expected)
+                return false;
+
+            pVMBlock block = (pVMBlock)receiver;
+            pVMMethod blockMethod = block->GetMethod();
+
+            //as in the evaluation primitive, after releasing the handles like
+            //any other send
+            _HEAP->ReleaseHandles();
+            pVMFrame newFrame = this->PushNewFrame(blockMethod);
+            newFrame->CopyArgumentsFrom(frame);
+            newFrame->SetContext(block->GetContext());
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+
+void Interpreter::doJump( int bytecodeIndex ) {
+    pVMMethod method = _METHOD;
+
+    int offset = Bytecode::GetJumpOffset(method->GetBytecodes() + bytecodeIndex);
+    _FRAME->SetBytecodeIndex(bytecodeIndex + offset);
+}
+
+
+void Interpreter::doJumpBackward( int bytecodeIndex ) {
+    pVMMethod method = _METHOD;
+
+    int offset = Bytecode::GetJumpOffset(method->GetBytecodes() + bytecodeIndex);
+    _FRAME->SetBytecodeIndex(bytecodeIndex - offset);
+
+    //a loop doesn't send anything on its own, so it releases the handles
+    _HEAP->ReleaseHandles();
+}
+
+
+void Interpreter::doJumpIf( int bytecodeIndex, pVMObject jumpValue ) {
+    pVMObject condition = _FRAME->GetStackElement(0);
+
+    if (condition == jumpValue) {
+        _FRAME->Pop();
+        this->doJump(bytecodeIndex);
+    } else if (condition == trueObject || condition == falseObject) {
+        _FRAME->Pop();
+    } else
+        this->sendInlined(bytecodeIndex);
+}
+
+
+void Interpreter::sendInlined( int bytecodeIndex ) {
+    //the test of inlined code answered no Boolean: send the message its
+    //descriptor describes instead
+    pVMMethod method = _METHOD;
+    pVMArray inlined = (pVMArray) method->GetConstant(bytecodeIndex + 2);
+
+    //the value of the test is popped before the blocks are created
+    Heap::PreventRetry();
+
+    pVMSymbol signature = (pVMSymbol) (*inlined)[INLINED_SELECTOR];
+    int numOfArgs = Signature::GetNumberOfArguments(signature);
+
+    //the result of the message takes the place of the inlined code
+    _FRAME->SetBytecodeIndex(INT_VAL((*inlined)[INLINED_RESUME]));
+
+    //the value of the test stays where it is as the receiver, or follows
+    //the other arguments
+    int first = 0;
+    pVMObject value = NULL;
+    if ((*inlined)[INLINED_RECEIVER] == nilObject) first = 1;
+    else value = _FRAME->Pop();
+
+    for (int i = first; i < numOfArgs; ++i) {
+        pVMObject part = (*inlined)[INLINED_RECEIVER + i];
+        if (part == nilObject)
+            _FRAME->Push(value);
+        else if (CLASS_OF(part) == integerClass)
+            _FRAME->Push(_FRAME->GetLocal(INT_VAL(part), 0));
+        else {
+            pVMMethod blockMethod = (pVMMethod) part;
+            pVMBlock block = _UNIVERSE->NewBlock(blockMethod, _FRAME,
+                                        blockMethod->GetNumberOfArguments());
+            _FRAME->Push((pVMObject) block);
+        }
+    }
+
+    pVMObject receiver = _FRAME->GetStackElement(numOfArgs - 1);
+    this->send(signature, CLASS_OF(receiver));
+}
+
@@ -39,6 +39,7 @@ class VMMethod;
 class VMObject;
 class VMSymbol;
 class VMClass;
+class InlineCache;
 
 class Interpreter {
 public:
@@ -46,19 +47,52 @@ public:
     ~Interpreter();
     void Start();
     pVMFrame PushNewFrame(pVMMethod method);
+    //frames live on a contiguous native stack until something needs them on
+    //the heap, e.g. a block capturing its context
+    bool IsNativeFrame(pVMFrame frame) const;
+    pVMFrame ReifyFrame(pVMFrame frame);
     void SetFrame(pVMFrame frame);
     pVMFrame GetFrame();
     pVMMethod GetMethod();
     pVMObject GetSelf();
+    //the current frame roots the frame chain and all contexts
+    void WalkFrames(RootWalker walk, void* data);
+    //a primitive pops its arguments, but may still use them after an
+    //allocation: while it runs, the slots of its frame up to the stack
+    //pointer it was called with are alive
+    void SetPrimitiveFrame(pVMFrame frame, int32_t stackPointer);
+    pVMFrame GetPrimitiveFrame() const { return primitiveFrame; }
+    int32_t GetPrimitiveStackPointer() const { return primitiveStackPointer; }
+    //the bytecode sequences executed most often, to pick superinstructions
+    void PrintBytecodeProfile();
 private:
     pVMFrame frame;
+    pVMFrame primitiveFrame;
+    int32_t  primitiveStackPointer;
+    int      restartIndex;
+    char* frameStack;
+    char* frameStackTop;
+    char* frameStackEnd;
     StdString uG;
     StdString dnu;
     StdString eB;
 
+    uint64_t* pairCounts;
+    uint64_t* tripleCounts;
+    uint64_t  bytecodeCount;
+    pVMFrame  profiledFrame;
+    int       profiledNextIndex;
+    int       profiledPrevious[2];
+
+    void startSwitch();
+    void startThreaded();
+    void restartBytecode();
+    void profileBytecode(int bytecodeIndex, uint8_t bytecode);
+
     pVMFrame popFrame();
     void popFrameAndPushResult(pVMObject result);
-    void send(pVMSymbol signature, pVMClass receiverClass);
+    void send(pVMSymbol signature, pVMClass receiverClass,
+              InlineCache* cache = NULL);
     
     void doDup();
     void doPushLocal(int bytecodeIndex);
@@ -75,6 +109,14 @@ private:
     void doSuperSend(int bytecodeIndex);
     void doReturnLocal();
     void doReturnNonLocal();
+    void doReturnSelf();
+    void doReturnField(int bytecodeIndex);
+    void doReturnConstant(int bytecodeIndex);
+    bool doSpecialSend(uint8_t bytecode);
+    void doJump(int bytecodeIndex);
+    void doJumpBackward(int bytecodeIndex);
+    void doJumpIf(int bytecodeIndex, pVMObject jumpValue);
+    void sendInlined(int bytecodeIndex);
 };
 
 #endif
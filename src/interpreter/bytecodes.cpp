@@ -1,5 +1,7 @@
 #include "bytecodes.h"
 
+#include <string.h>
+
 /*
  *
  *
@@ -40,10 +42,39 @@ const uint8_t Bytecode::bytecodeLengths[] = {
     3, // BC_POP_LOCAL
     3, // BC_POP_ARGUMENT
     2, // BC_POP_FIELD
-    2, // BC_SEND
-    2, // BC_SUPER_SEND
+    4, // BC_SEND
+    4, // BC_SUPER_SEND
     1, // BC_RETURN_LOCAL
-    1  // BC_RETURN_NON_LOCAL
+    1, // BC_RETURN_NON_LOCAL
+    3, // BC_JUMP
+    4, // BC_JUMP_IF_TRUE
+    4, // BC_JUMP_IF_FALSE
+    3, // BC_JUMP_BACKWARD
+    4, // BC_SEND_PLUS
+    4, // BC_SEND_MINUS
+    4, // BC_SEND_STAR
+    4, // BC_SEND_LESS
+    4, // BC_SEND_MORE
+    4, // BC_SEND_LESS_EQUAL
+    4, // BC_SEND_MORE_EQUAL
+    4, // BC_SEND_EQUAL
+    4, // BC_SEND_IDENTICAL
+    4, // BC_SEND_AT
+    4, // BC_SEND_AT_PUT
+    4, // BC_SEND_LENGTH
+    4, // BC_SEND_VALUE
+    4, // BC_SEND_VALUE_ARG
+    1, // BC_RETURN_SELF
+    2, // BC_RETURN_FIELD
+    2, // BC_RETURN_CONSTANT
+    5, // BC_PUSH_LOCAL_CONSTANT
+    6, // BC_PUSH_ARGUMENT_ARGUMENT
+    6, // BC_PUSH_ARGUMENT_LOCAL
+    4, // BC_POP_PUSH_LOCAL
+    7, // BC_PUSH_ARGUMENT_SEND
+    6, // BC_PUSH_CONSTANT_SEND_PLUS
+    8, // BC_LESS_EQUAL_JUMP_IF_FALSE
+    3  // BC_PUSH_FIELD_RETURN_LOCAL
 };
 
 const char* Bytecode::bytecodeNames[] = {
@@ -62,7 +93,73 @@ const char* Bytecode::bytecodeNames[] = {
     "SEND            ",
     "SUPER_SEND      ",
     "RETURN_LOCAL    ",
-    "RETURN_NON_LOCAL"
+    "RETURN_NON_LOCAL",
+    "JUMP            ",
+    "JUMP_IF_TRUE    ",
+    "JUMP_IF_FALSE   ",
+    "JUMP_BACKWARD   ",
+    "SEND_PLUS       ",
+    "SEND_MINUS      ",
+    "SEND_STAR       ",
+    "SEND_LESS       ",
+    "SEND_MORE       ",
+    "SEND_LESS_EQUAL ",
+    "SEND_MORE_EQUAL ",
+    "SEND_EQUAL      ",
+    "SEND_IDENTICAL  ",
+    "SEND_AT         ",
+    "SEND_AT_PUT     ",
+    "SEND_LENGTH     ",
+    "SEND_VALUE      ",
+    "SEND_VALUE_ARG  ",
+    "RETURN_SELF     ",
+    "RETURN_FIELD    ",
+    "RETURN_CONSTANT ",
+    "PUSH_LOCAL_CONSTANT",
+    "PUSH_ARGUMENT_ARGUMENT",
+    "PUSH_ARGUMENT_LOCAL",
+    "POP_PUSH_LOCAL  ",
+    "PUSH_ARGUMENT_SEND",
+    "PUSH_CONSTANT_SEND_PLUS",
+    "LESS_EQUAL_JUMP_IF_FALSE",
+    "PUSH_FIELD_RETURN_LOCAL"
+};
+
+// the selectors of BC_SEND_PLUS to BC_SEND_VALUE_ARG, in that order
+const char* Bytecode::specialSelectors[] = {
+    "+", "-", "*", "<", ">", "<=", ">=", "=", "==", 
+    "at:", "at:put:", "length", "value", "value:", NULL
 };
 
 
+// the sequences of BC_PUSH_LOCAL_CONSTANT to BC_PUSH_FIELD_RETURN_LOCAL,
+// in that order
+const uint8_t Bytecode::superinstructions[][2] = {
+    { BC_PUSH_LOCAL,      BC_PUSH_CONSTANT },
+    { BC_PUSH_ARGUMENT,   BC_PUSH_ARGUMENT },
+    { BC_PUSH_ARGUMENT,   BC_PUSH_LOCAL },
+    { BC_POP,             BC_PUSH_LOCAL },
+    { BC_PUSH_ARGUMENT,   BC_SEND },
+    { BC_PUSH_CONSTANT,   BC_SEND_PLUS },
+    { BC_SEND_LESS_EQUAL, BC_JUMP_IF_FALSE },
+    { BC_PUSH_FIELD,      BC_RETURN_LOCAL }
+};
+
+
+uint8_t Bytecode::GetSuperinstruction(uint8_t first, uint8_t second) {
+    for (int i = 0; i < NUMBER_OF_BYTECODES - BC_PUSH_LOCAL_CONSTANT; ++i)
+        if (superinstructions[i][0] == first &&
+            superinstructions[i][1] == second)
+            return BC_PUSH_LOCAL_CONSTANT + i;
+    return BC_HALT;
+}
+
+
+uint8_t Bytecode::GetSendBytecode(const char* selector) {
+    for (int i = 0; specialSelectors[i] != NULL; ++i)
+        if (strcmp(selector, specialSelectors[i]) == 0)
+            return BC_SEND_PLUS + i;
+    return BC_SEND;
+}
+
+
@@ -49,6 +49,67 @@ THE SOFTWARE.
 #define BC_SUPER_SEND        13
 #define BC_RETURN_LOCAL      14
 #define BC_RETURN_NON_LOCAL  15
+#define BC_JUMP              16
+#define BC_JUMP_IF_TRUE      17
+#define BC_JUMP_IF_FALSE     18
+#define BC_JUMP_BACKWARD     19
+
+// The operands of a send are the index of the selector in the literals, the
+// inline cache of the send site and the number of arguments, which is known
+// to the compiler.
+//
+// Sends of the most frequent selectors have bytecodes of their own, with the
+// operands of BC_SEND. The interpreter handles the common case of integer,
+// array and block receivers directly and sends the message otherwise.
+#define BC_SEND_PLUS         20
+#define BC_SEND_MINUS        21
+#define BC_SEND_STAR         22
+#define BC_SEND_LESS         23
+#define BC_SEND_MORE         24
+#define BC_SEND_LESS_EQUAL   25
+#define BC_SEND_MORE_EQUAL   26
+#define BC_SEND_EQUAL        27
+#define BC_SEND_IDENTICAL    28
+#define BC_SEND_AT           29
+#define BC_SEND_AT_PUT       30
+#define BC_SEND_LENGTH       31
+#define BC_SEND_VALUE        32
+#define BC_SEND_VALUE_ARG    33
+
+// Returns of self, a field and a constant, which the optimizer (-O) emits for
+// a push followed by BC_RETURN_LOCAL. BC_RETURN_SELF returns argument 0 of the
+// frame, the others have the operand of BC_PUSH_FIELD and BC_PUSH_CONSTANT.
+#define BC_RETURN_SELF       34
+#define BC_RETURN_FIELD      35
+#define BC_RETURN_CONSTANT   36
+
+// Superinstructions for the sequences of two bytecodes executed most often, as
+// profiled with -p over the benchmarks and the test suite. A superinstruction
+// replaces the first bytecode of its sequence only: the operands and the
+// second bytecode stay in place, so the length and the jump targets of the
+// code don't change, and a jump to the second bytecode still finds it.
+#define BC_PUSH_LOCAL_CONSTANT        37
+#define BC_PUSH_ARGUMENT_ARGUMENT     38
+#define BC_PUSH_ARGUMENT_LOCAL        39
+#define BC_POP_PUSH_LOCAL             40
+#define BC_PUSH_ARGUMENT_SEND         41
+#define BC_PUSH_CONSTANT_SEND_PLUS    42
+#define BC_LESS_EQUAL_JUMP_IF_FALSE   43
+#define BC_PUSH_FIELD_RETURN_LOCAL    44
+
+#define NUMBER_OF_BYTECODES  45
+
+// A conditional jump is the test of a message the compiler inlined. If the
+// test doesn't answer a Boolean, a message is sent instead, as described by
+// the array the jump's last operand refers to: the selector, the bytecode
+// index to continue at with the result, then the receiver and the arguments.
+// Of these, nil stands for the value of the test, which is the receiver or
+// the last argument, an integer for the local with that index, and a method
+// for a block of it. For a conditional that is the original message, for a
+// loop one continuing it with the value of the test.
+#define INLINED_SELECTOR     0
+#define INLINED_RESUME       1
+#define INLINED_RECEIVER     2
 
 // bytecode lengths
 
@@ -65,11 +126,41 @@ public:
         return bytecodeLengths[bc];// Return the length of the given bytecode
     }
 
+    // the distance a jump at bc goes, stored low byte first after it
+    static int GetJumpOffset(const uint8_t* bc) {
+        return bc[1] | (bc[2] << 8);
+    }
+
+    static bool IsSend(uint8_t bc) {
+        return bc == BC_SEND || 
+               (bc >= BC_SEND_PLUS && bc <= BC_SEND_VALUE_ARG);
+    }
+
+    // the bytecode sending selector, BC_SEND unless it is a special one
+    static uint8_t GetSendBytecode(const char* selector);
+
+    static bool IsSuperinstruction(uint8_t bc) {
+        return bc >= BC_PUSH_LOCAL_CONSTANT;
+    }
+
+    // the superinstruction for first followed by second, or BC_HALT if
+    // there is none
+    static uint8_t GetSuperinstruction(uint8_t first, uint8_t second);
+
+    // the bytecode a superinstruction took the place of
+    static uint8_t GetFirstBytecode(uint8_t superinstruction) {
+        return superinstructions[superinstruction - BC_PUSH_LOCAL_CONSTANT][0];
+    }
+
 private:
     
 static const uint8_t bytecodeLengths[];
 
 static const char* bytecodeNames[];
+
+static const char* specialSelectors[];
+
+static const uint8_t superinstructions[][2];
 };
 
 
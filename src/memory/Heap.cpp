@@ -64,6 +64,11 @@ THE SOFTWARE.
 #define PAD_BYTES(N) ((sizeof(void*) - ((N) % sizeof(void*))) % sizeof(void*))
 
 Heap * Heap::theHeap = NULL;
+bool Heap::safepointRequested = false;
+bool Heap::compactionRequested = false;
+bool Heap::atSafepoint = false;
+bool Heap::retryAllowed = false;
+int Heap::retrySafepoints = 0;
 
 Heap* Heap::GetHeap() {
     if (!theHeap) {
@@ -131,6 +136,12 @@ Heap::Heap(uintptr_t objectSpaceSize,OMR_VM_Example *vm) {
 	omrtty_printf("garbage collector is %s\n", env->getExtensions()->getGlobalCollector()->getBaseVirtualTypeId());
 	omrtty_printf("allocation interface is %s\n", allocationInterface->getBaseVirtualTypeId());
 	 numAlloc = 0;
+#if defined(OMR_GC_MODRON_COMPACTION)
+	//OMR only compacts with -Xcompactgc. A fragmented heap can only grow, so
+	//let the collector decide, the compaction is deferred to a safepoint
+	extensions->noCompactOnGlobalGC = 0;
+	extensions->nocompactOnSystemGC = 0;
+#endif /* defined(OMR_GC_MODRON_COMPACTION) */
 }
 
 Heap::~Heap() {
@@ -164,7 +175,12 @@ VMObject* Heap::AllocateObject(size_t s) {
     VMObject* vmo = (VMObject*) Allocate(size);
     if(vmo != NULL){
     vmo->SetObjectSize(s);  //zg. save the requested size.
-    //TODO: How to do so? zg.add this object into the objectTable.??How to define the name of it.
+#ifdef HEAP_DEBUG
+    //remember every allocation in the side table of the VM, the entries of
+    //dead objects are removed after each GC
+    ObjectEntry oEntry = {NULL, (omrobjectptr_t)vmo, 0};
+    hashTableAdd(_vm->objectTable, &oEntry);
+#endif
 
     }
     return vmo;
@@ -187,6 +203,14 @@ void* Heap::Allocate(size_t size) {
         addUninterruptableAllocationObject(obj);      // TODD @A1A Begin
 		//((VMObject *) obj )->SetObjectSize(size);   //zg. no need to set.  as it's already in the first word( 4 bytes) .  The first byte is reserved for age&flag, and the remains 3 bytes are for size.
 	}else{
+#if defined(OMR_GC_MODRON_COMPACTION)
+        //the compaction that would make room waits for a safepoint, where
+        //the interpreter allocates again
+        if (compactionRequested && retryAllowed && retrySafepoints == 0) {
+            retrySafepoints = 2;
+            throw AllocationRetry();
+        }
+#endif /* defined(OMR_GC_MODRON_COMPACTION) */
 		std::cout <<"ERROR: allocation failure."<<std::endl;
 	}
 
@@ -212,13 +236,45 @@ void Heap::PrintFreeList() {
 void Heap::FullGC() {
 	//TODO: How to do  manual GC on OMR?
    //OMR_GC_SystemCollect();
+#if defined(OMR_GC_MODRON_COMPACTION)
+	//the primitive is followed by a safepoint, which collects and compacts
+	//in one go
+	RequestCompaction();
+#else
 	extensions->heap->systemGarbageCollect(env,J9MMCONSTANT_EXPLICIT_GC_SYSTEM_GC);
+#endif /* defined(OMR_GC_MODRON_COMPACTION) */
 	//From Liu Yan: TODO
 //	MM_MemorySpace *memorySpace = env->getMemorySpace();
 //	    memorySpace->localGarbageCollect(env);
    // gc->Collect();
 }
 
+size_t Heap::GetUsedMemory() {
+    return extensions->heap->getMemorySize() -
+           extensions->heap->getActualFreeMemorySize();
+}
+
+void Heap::ReachSafepoint() {
+    safepointRequested = false;
+    atSafepoint = true;
+    if (compactionRequested) Compact();
+    //the bytecode restarted after the safepoint of a retry runs up to the
+    //next one
+    if (retrySafepoints > 0 && --retrySafepoints > 0) safepointRequested = true;
+    atSafepoint = false;
+}
+
+void Heap::Compact() {
+    compactionRequested = false;
+#if defined(OMR_GC_MODRON_COMPACTION)
+    //an explicit collection compacts if compactOnSystemGC is set, whatever
+    //the fragmentation of the heap is
+    extensions->compactOnSystemGC = 1;
+    extensions->heap->systemGarbageCollect(env, J9MMCONSTANT_EXPLICIT_GC_SYSTEM_GC);
+    extensions->compactOnSystemGC = 0;
+#endif /* defined(OMR_GC_MODRON_COMPACTION) */
+}
+
 void Heap::Free(void* ptr) {
 	//TODO: how to check whether one ptr is in OMR heap or not?
 	/*
@@ -281,8 +337,19 @@ void Heap::StartUninterruptableAllocation()
 
 void Heap::EndUninterruptableAllocation() 
 {   
-    if( (--uninterruptableCounter) == 0 )
+    --uninterruptableCounter;
+}
+
+
+void Heap::ReleaseHandles() 
+{   
+    if (uninterruptableCounter == 0)
     {   removeAllUninterruptableAllocationObject();        
     }
 }
 // TODD @A1A End
+
+void Heap::AbandonAllocations() {
+    uninterruptableCounter = 0;
+    removeAllUninterruptableAllocationObject();
+}
@@ -77,14 +77,62 @@ public:
 	
     void StartUninterruptableAllocation();  // TODD @A1M: Enhance UninterruptableXXX functions to prevent  
     void EndUninterruptableAllocation();    // the new allocated memory being deleted - 11/06/2016
+    //New objects are rooted as handles, so that C++ code may keep them in
+    //locals across further allocations. The interpreter releases them where
+    //everything alive is reachable from the frame chain.
+    void ReleaseHandles();
+
+    //Compaction moves objects, but only the slots walked as roots are
+    //updated: the C++ locals of the VM keep pointing to the old places. So a
+    //collection caused by an allocation never compacts, it requests the
+    //compaction instead. The interpreter compacts at its next safepoint, where
+    //it reloads all its state from the frames.
+    static inline void Safepoint() {
+        if (safepointRequested) theHeap->ReachSafepoint();
+    }
+    static inline bool IsSafepointRequested() { return safepointRequested; }
+    static inline void RequestCompaction() {
+        compactionRequested = true;
+        safepointRequested = true;
+    }
+    static inline bool IsAtSafepoint() { return atSafepoint; }
+
+    //An allocation that still fails once its collection requested a
+    //compaction throws AllocationRetry. The interpreter then runs the
+    //bytecode that allocated again, starting with the safepoint that
+    //compacts, see Interpreter::restartBytecode. Code that changes the frames
+    //in ways a restart doesn't undo prevents retries up to the next
+    //safepoint; so does the retry itself, which would not help twice.
+    class AllocationRetry {};
+    static inline void AllowRetry(bool allowed) { retryAllowed = allowed; }
+    static inline void PreventRetry() {
+        if (retrySafepoints == 0) retrySafepoints = 1;
+        safepointRequested = true;
+    }
+    //the handles of the failed attempt, including those of objects under
+    //construction, are released
+    void AbandonAllocations();
 
    // void PrintFreeList();
     
     void FullGC();
+    //the bytes of the heap taken by objects, including the garbage not
+    //collected yet
+    size_t GetUsedMemory();
     OMR_VM_Example * getVM(){return _vm;}
     
 private:
     static class Heap * theHeap;
+    //see Safepoint
+    static bool safepointRequested;
+    static bool compactionRequested;
+    static bool atSafepoint;
+    //see AllocationRetry
+    static bool retryAllowed;
+    static int  retrySafepoints;
+
+    void ReachSafepoint();
+    void Compact();
 
     void internalFree(void* ptr);
 	void* internalAllocate(size_t size);
@@ -44,10 +44,9 @@ THE SOFTWARE.
 
 #define CHECK_BIGINT(object, result) { \
     /* Check second parameter type: */ \
-    pVMInteger ptr;\
-    if((ptr = dynamic_cast<pVMInteger>(object)) != NULL) { \
+    if(IS_TAGGED(object) || dynamic_cast<pVMInteger>(object) != NULL) { \
         /* Second operand was Integer*/ \
-        int32_t i = ptr->GetEmbeddedInteger(); \
+        int32_t i = INT_VAL(object); \
         (result) = _UNIVERSE->NewBigInteger((int64_t)i); \
     } else \
         (result) = (pVMBigInteger)(object); \
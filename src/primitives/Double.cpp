@@ -46,10 +46,12 @@ THE SOFTWARE.
  * true nature. This is to make sure that all Double operations return Doubles.
  */
 double _Double::coerceDouble(pVMObject x) {
-    if(dynamic_cast<pVMDouble>(x) != NULL)
+    if(IS_TAGGED(x))
+        return (double)INT_VAL(x);
+    else if(dynamic_cast<pVMDouble>(x) != NULL)
         return ((pVMDouble)x)->GetEmbeddedDouble();
     else if(dynamic_cast<pVMInteger>(x) != NULL)
-        return (double)((pVMInteger)x)->GetEmbeddedInteger();
+        return (double)INT_VAL(x);
     else if(dynamic_cast<pVMBigInteger>(x) != NULL)
         return (double)((pVMBigInteger)x)->GetEmbeddedInteger();
     else
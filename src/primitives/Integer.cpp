@@ -50,7 +50,9 @@ THE SOFTWARE.
  * of an Integer operation).
  */
 #define CHECK_COERCION(obj,receiver,op) { \
-    if(dynamic_cast<pVMBigInteger>(obj) != NULL) { \
+    if(IS_TAGGED(obj)) { \
+        /* tagged integers never need coercion */ \
+    } else if(dynamic_cast<pVMBigInteger>(obj) != NULL) { \
         resendAsBigInteger( \
             object, (op), (receiver), (pVMBigInteger)(obj)); \
         return; \
@@ -119,12 +121,12 @@ void _Integer::resendAsBigInteger(pVMObject /*object*/,
                                   pVMInteger left, pVMBigInteger right) {
     // Construct left value as BigInteger:
     pVMBigInteger leftBigInteger = 
-        _UNIVERSE->NewBigInteger((int64_t)left->GetEmbeddedInteger());
+        _UNIVERSE->NewBigInteger((int64_t)INT_VAL(left));
     
     // Resend message:
     pVMObject operands[] = { (pVMObject)right };
     
-    leftBigInteger->Send(op, operands, 1);
+    VMObject::Send(leftBigInteger, op, operands, 1);
     // no reference
 }
 
@@ -133,10 +135,10 @@ void _Integer::resendAsDouble(pVMObject /*object*/, const char* op,
     pVMInteger left, pVMDouble right
 ) {
     pVMDouble leftDouble =
-        _UNIVERSE->NewDouble((double)left->GetEmbeddedInteger());
+        _UNIVERSE->NewDouble((double)INT_VAL(left));
     pVMObject operands[] = { (pVMObject)right };
     
-    leftDouble->Send(op, operands, 1);
+    VMObject::Send(leftDouble, op, operands, 1);
 }
 
 
@@ -155,8 +157,8 @@ void  _Integer::Plus(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
     
-    int64_t result = (int64_t)left->GetEmbeddedInteger() + 
-        (int64_t)right->GetEmbeddedInteger();
+    int64_t result = (int64_t)INT_VAL(left) + 
+        (int64_t)INT_VAL(right);
     pushResult(object, frame, result);
 }
 
@@ -170,8 +172,8 @@ void  _Integer::Minus(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
     
-    int64_t result = (int64_t)left->GetEmbeddedInteger() - 
-        (int64_t)right->GetEmbeddedInteger();
+    int64_t result = (int64_t)INT_VAL(left) - 
+        (int64_t)INT_VAL(right);
     pushResult(object, frame, result);
 }
 
@@ -185,8 +187,8 @@ void  _Integer::Star(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
     
-    int64_t result = (int64_t)left->GetEmbeddedInteger() * 
-        (int64_t)right->GetEmbeddedInteger();
+    int64_t result = (int64_t)INT_VAL(left) * 
+        (int64_t)INT_VAL(right);
     pushResult(object, frame, result); 
 }
 
@@ -200,8 +202,8 @@ void  _Integer::Slashslash(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
     
-    double result = (double)left->GetEmbeddedInteger() /
-        (double)right->GetEmbeddedInteger();
+    double result = (double)INT_VAL(left) /
+        (double)INT_VAL(right);
     frame->Push(_UNIVERSE->NewDouble(result));
 }
 
@@ -215,8 +217,8 @@ void  _Integer::Slash(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
     
-    int64_t result = (int64_t)left->GetEmbeddedInteger() / 
-        (int64_t)right->GetEmbeddedInteger();
+    int64_t result = (int64_t)INT_VAL(left) / 
+        (int64_t)INT_VAL(right);
     pushResult(object, frame, result); 
 }
 
@@ -230,8 +232,8 @@ void  _Integer::Percent(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
 
-    int64_t result = (int64_t)left->GetEmbeddedInteger() %
-        (int64_t)right->GetEmbeddedInteger();
+    int64_t result = (int64_t)INT_VAL(left) %
+        (int64_t)INT_VAL(right);
     pushResult(object, frame, result); 
 }
 
@@ -245,8 +247,8 @@ void  _Integer::And(pVMObject object, pVMFrame frame) {
     // Do operation:
     pVMInteger right = (pVMInteger)rightObj;
     
-    int64_t result = (int64_t)left->GetEmbeddedInteger() & 
-        (int64_t)right->GetEmbeddedInteger();
+    int64_t result = (int64_t)INT_VAL(left) & 
+        (int64_t)INT_VAL(right);
     pushResult(object, frame, result); 
 }   
 
@@ -257,12 +259,12 @@ void  _Integer::Equal(pVMObject object, pVMFrame frame) {
     
     CHECK_COERCION(rightObj, left, "=");
 
-    if(dynamic_cast<pVMInteger>(rightObj) != NULL) {
+    if(IS_TAGGED(rightObj) || dynamic_cast<pVMInteger>(rightObj) != NULL) {
         // Second operand was Integer:
         pVMInteger right = (pVMInteger)rightObj;
         
-        if(left->GetEmbeddedInteger()
-            == right->GetEmbeddedInteger())
+        if(INT_VAL(left)
+            == INT_VAL(right))
             frame->Push(trueObject);
         else
             frame->Push(falseObject);
@@ -270,7 +272,7 @@ void  _Integer::Equal(pVMObject object, pVMFrame frame) {
         // Second operand was Double:
         pVMDouble right = (pVMDouble)rightObj;
         
-        if((double)left->GetEmbeddedInteger()
+        if((double)INT_VAL(left)
             == right->GetEmbeddedDouble())
             frame->Push(trueObject);
         else
@@ -289,7 +291,7 @@ void  _Integer::Lowerthan(pVMObject object, pVMFrame frame) {
 
     pVMInteger right = (pVMInteger)rightObj;
     
-    if(left->GetEmbeddedInteger() < right->GetEmbeddedInteger())
+    if(INT_VAL(left) < INT_VAL(right))
         frame->Push(trueObject);
     else
         frame->Push(falseObject);
@@ -299,7 +301,7 @@ void  _Integer::Lowerthan(pVMObject object, pVMFrame frame) {
 void  _Integer::AsString(pVMObject /*object*/, pVMFrame frame) {
     pVMInteger self = (pVMInteger)frame->Pop();
     
-    int32_t integer = self->GetEmbeddedInteger();
+    int32_t integer = INT_VAL(self);
     ostringstream Str;
     Str << integer;
     frame->Push( (pVMObject)_UNIVERSE->NewString( Str.str() ) );   
@@ -308,14 +310,14 @@ void  _Integer::AsString(pVMObject /*object*/, pVMFrame frame) {
 
 void  _Integer::Sqrt(pVMObject /*object*/, pVMFrame frame) {
     pVMInteger self = (pVMInteger)frame->Pop();
-    double result = sqrt((double)self->GetEmbeddedInteger());
+    double result = sqrt((double)INT_VAL(self));
     frame->Push((pVMObject)_UNIVERSE->NewDouble(result));
 }
 
 
 void  _Integer::AtRandom(pVMObject /*object*/, pVMFrame frame) {
     pVMInteger self = (pVMInteger)frame->Pop();
-    int32_t result = (self->GetEmbeddedInteger() * rand())%INT32_MAX;
+    int32_t result = (INT_VAL(self) * rand())%INT32_MAX;
     frame->Push((pVMObject) _UNIVERSE->NewInteger(result));
 }
 
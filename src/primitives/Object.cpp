@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include <vmobjects/VMObject.h>
 #include <vmobjects/VMFrame.h>
+#include <vmobjects/VMInteger.h>
 
 #include <vm/Universe.h>
  
@@ -54,13 +55,17 @@ void  _Object::Equalequal(pVMObject /*object*/, pVMFrame frame) {
 
 void  _Object::ObjectSize(pVMObject /*object*/, pVMFrame frame) {
     pVMObject self = frame->Pop();
+    // a tagged integer reports the size it would have as a boxed VMInteger
+    int32_t size = IS_TAGGED(self) ? (int32_t)sizeof(VMInteger)
+                                   : self->GetObjectSize();
 
-    frame->Push( (pVMObject)_UNIVERSE->NewInteger(self->GetObjectSize()) );
+    frame->Push( (pVMObject)_UNIVERSE->NewInteger(size) );
 }
 
 
 void  _Object::Hashcode(pVMObject /*object*/, pVMFrame frame) {
     pVMObject self = frame->Pop();
-    frame->Push( (pVMObject)_UNIVERSE->NewInteger(self->GetHash()) );
+    int32_t hash = IS_TAGGED(self) ? INT_VAL(self) : self->GetHash();
+    frame->Push( (pVMObject)_UNIVERSE->NewInteger(hash) );
 }
 
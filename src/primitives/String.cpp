@@ -74,8 +74,8 @@ void  _String::Concatenate_(pVMObject /*object*/, pVMFrame frame) {
 
 void  _String::AsSymbol(pVMObject /*object*/, pVMFrame frame) {
     pVMString self = (pVMString)frame->Pop();
-    StdString result = self->GetStdString();
-    frame->Push((pVMObject)_UNIVERSE->SymbolFor(result));
+    frame->Push((pVMObject)_UNIVERSE->SymbolForChars(self->GetChars(),
+                                                     self->GetStringLength()));
 }
 
 
@@ -97,7 +97,7 @@ void  _String::Equal(pVMObject /*object*/, pVMFrame frame) {
     pVMObject op1 = frame->Pop();
     pVMString op2 = (pVMString)frame->Pop();
     
-    if(op1->GetClass() == op2->GetClass()) {
+    if(CLASS_OF(op1) == op2->GetClass()) {
         
         StdString s1 = ((pVMString)op1)->GetStdString();
         StdString s2 = op2->GetStdString();
@@ -118,8 +118,8 @@ void  _String::PrimSubstringFrom_To_(pVMObject /*object*/, pVMFrame frame) {
     pVMString self = (pVMString)frame->Pop();
     
     StdString str = self->GetStdString();
-    int s = start->GetEmbeddedInteger();
-    int e = end->GetEmbeddedInteger();
+    int s = INT_VAL(start);
+    int e = INT_VAL(end);
     
     StdString result = str.substr(s, e - s);
 
@@ -80,7 +80,7 @@ void  _System::Load_(pVMObject /*object*/, pVMFrame frame) {
 
 void  _System::Exit_(pVMObject /*object*/, pVMFrame frame) {
     pVMInteger err = (pVMInteger)frame->Pop();
-    int32_t err_no = err->GetEmbeddedInteger();
+    int32_t err_no = INT_VAL(err);
 
     if(err_no != ERR_SUCCESS)
         frame->PrintStackTrace();
@@ -103,17 +103,15 @@ void  _System::PrintNewline(pVMObject /*object*/, pVMFrame /*frame*/) {
 void  _System::Time(pVMObject /*object*/, pVMFrame frame) {
     /*pVMObject self = */
     frame->Pop();
-    timeval* now = new timeval();
+    timeval now;
 
-    gettimeofday(now, NULL);
+    gettimeofday(&now, NULL);
 
     long long diff = 
-        ((now->tv_sec - start_time->tv_sec) * 1000) + //seconds
-        ((now->tv_usec - start_time->tv_usec) / 1000); // µseconds
+        ((now.tv_sec - start_time->tv_sec) * 1000) + //seconds
+        ((now.tv_usec - start_time->tv_usec) / 1000); // µseconds
 
     frame->Push((pVMObject)_UNIVERSE->NewInteger((int32_t)diff));
-
-    delete(now);
 }
 
 
@@ -123,6 +121,14 @@ void _System::FullGC(pVMObject /*object*/, pVMFrame frame) {
 }
 
 
+void _System::UsedMemory(pVMObject /*object*/, pVMFrame frame) {
+    /*pVMObject self = */
+    frame->Pop();
+    size_t used = _HEAP->GetUsedMemory();
+    frame->Push((pVMObject)_UNIVERSE->NewInteger((int32_t)used));
+}
+
+
 _System::_System(void) : PrimitiveContainer() {
     start_time = new timeval();
     gettimeofday(start_time, NULL);
@@ -158,6 +164,9 @@ _System::_System(void) : PrimitiveContainer() {
     this->SetPrimitive("fullGC",
         static_cast<PrimitiveRoutine*>(new
         Routine<_System>(this, &_System::FullGC)));
+    this->SetPrimitive("usedMemory",
+        static_cast<PrimitiveRoutine*>(new
+        Routine<_System>(this, &_System::UsedMemory)));
 }
 
 _System::~_System()
@@ -51,6 +51,7 @@ public:
     void PrintNewline(pVMObject object, pVMFrame frame);
     void Time(pVMObject object, pVMFrame frame);
     void FullGC(pVMObject object, pVMFrame frame);
+    void UsedMemory(pVMObject object, pVMFrame frame);
 
     
 private:
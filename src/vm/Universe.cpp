@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include "../vmobjects/VMBigInteger.h"
 #include "../vmobjects/VMEvaluationPrimitive.h"
 #include "../vmobjects/Symboltable.h"
+#include "../vmobjects/InlineCache.h"
 
 #include "../interpreter/bytecodes.h"
 
@@ -75,6 +76,8 @@ THE SOFTWARE.
 
 short dumpBytecodes;
 short gcVerbosity;
+short profileBytecodes;
+short optimizeBytecodes;
 
 
 
@@ -100,8 +103,25 @@ pVMClass primitiveClass;
 pVMClass stringClass;
 pVMClass systemClass;
 pVMClass blockClass;
+pVMClass block1Class;
+pVMClass block2Class;
+pVMClass block3Class;
 pVMClass doubleClass;
 
+//the VM-wide objects above are GC roots
+static pVMObject* const wellKnownObjects[] = {
+    &nilObject, &trueObject, &falseObject,
+    (pVMObject*)&objectClass, (pVMObject*)&classClass,
+    (pVMObject*)&metaClassClass, (pVMObject*)&nilClass,
+    (pVMObject*)&integerClass, (pVMObject*)&bigIntegerClass,
+    (pVMObject*)&arrayClass, (pVMObject*)&methodClass,
+    (pVMObject*)&symbolClass, (pVMObject*)&frameClass,
+    (pVMObject*)&primitiveClass, (pVMObject*)&stringClass,
+    (pVMObject*)&systemClass, (pVMObject*)&blockClass,
+    (pVMObject*)&block1Class, (pVMObject*)&block2Class,
+    (pVMObject*)&block3Class, (pVMObject*)&doubleClass
+};
+
 
 /* Start up */
 OMR_VM_Example exampleVM;
@@ -135,6 +155,8 @@ void Universe::Start(int argc, char** argv) {
 
 void Universe::Quit(int err) {
 //	
+    if (theUniverse && profileBytecodes && theUniverse->interpreter)
+        theUniverse->interpreter->PrintBytecodeProfile();
     if (theUniverse) delete(theUniverse);
     /* OMR. Shut down */
     int rc = 0;
@@ -157,18 +179,14 @@ void Universe::Quit(int err) {
     	rc = OMR_GC_ShutdownHeap(exampleVM._omrVM);
     	Assert_MM_true(OMR_ERROR_NONE == rc);
 //    	
-    	/* Free object hash table */
-    	hashTableForEachDo(exampleVM.objectTable, objectTableFreeFn, &exampleVM);
-//    	
-    	hashTableFree(exampleVM.objectTable);
-//    	
-    	exampleVM.objectTable = NULL;
+    	/* Free object hash table, it only exists in HEAP_DEBUG builds */
+    	if (NULL != exampleVM.objectTable) {
+    		hashTableForEachDo(exampleVM.objectTable, objectTableFreeFn, &exampleVM);
+    		hashTableFree(exampleVM.objectTable);
+    		exampleVM.objectTable = NULL;
+    	}
 
 
-    	/* Free root hash table */
-    	hashTableFree(exampleVM.rootTable);
-//    	
-    	exampleVM.rootTable = NULL;
 //    	
     	/* Balance the omrthread_attach_ex() issued above */
     	omrthread_detach(self);
@@ -198,6 +216,8 @@ vector<StdString> Universe::handleArguments( int argc, char** argv ) {
     vector<StdString> vmArgs = vector<StdString>();
     dumpBytecodes = 0;
     gcVerbosity = 0;
+    profileBytecodes = 0;
+    optimizeBytecodes = 0;
     for (int i = 1; i < argc ; ++i) {
         
         if (strncmp(argv[i], "-cp", 3) == 0) {
@@ -208,6 +228,10 @@ vector<StdString> Universe::handleArguments( int argc, char** argv ) {
             ++dumpBytecodes;
         } else if (strncmp(argv[i], "-g", 2) == 0) {
             ++gcVerbosity;
+        } else if (strncmp(argv[i], "-p", 2) == 0) {
+            profileBytecodes = 1;
+        } else if (strncmp(argv[i], "-O", 2) == 0) {
+            optimizeBytecodes = 1;
         } else if (argv[i][0] == '-' && argv[i][1] == 'H') {
             int heap_size = atoi(argv[i] + 2);
             heapSize = heap_size;
@@ -297,6 +321,8 @@ void Universe::printUsageAndExit( char* executable ) const {
                     "        2x - print statistics upon each collection" << endl <<
                     "        3x - print statistics and dump _HEAP upon each "  << endl <<
                     "collection" << endl;
+    cout << "    -p  print the most frequent bytecode pairs and triples" << endl;
+    cout << "    -O  optimize the bytecodes of compiled methods" << endl;
     cout << "    -Hx set the _HEAP size to x MB (default: 1 MB)" << endl;
     cout << "    -h  show this help" << endl;
 
@@ -308,6 +334,10 @@ Universe::Universe(){
 	this->compiler = NULL;
 	this->symboltable = NULL;
 	this->interpreter = NULL;
+	this->globalsCapacity = 256;
+	this->numberOfGlobals = 0;
+	this->globals = new pVMArray[globalsCapacity];
+	memset(globals, 0, globalsCapacity * sizeof(pVMArray));
 };
 
 
@@ -329,15 +359,12 @@ void Universe::initialize(int _argc, char** _argv) {
 	int j9rc = (int) omrthread_attach_ex(&self, J9THREAD_ATTR_DEFAULT);
 	Assert_MM_true(0 == j9rc);
 //	 
-	/* Initialize root table */
-	exampleVM.rootTable = hashTableNew(
-			exampleVM._omrVM->_runtime->_portLibrary, OMR_GET_CALLSITE(), 0, sizeof(RootEntry), 0, 0, OMRMEM_CATEGORY_MM,
-			rootTableHashFn, rootTableHashEqualFn, NULL, NULL);
-//	 
-	/* Initialize object table */
+#ifdef HEAP_DEBUG
+	/* Initialize object table, a side table of all live objects keyed by address */
 	exampleVM.objectTable = hashTableNew(
 			exampleVM._omrVM->_runtime->_portLibrary, OMR_GET_CALLSITE(), 0, sizeof(ObjectEntry), 0, 0, OMRMEM_CATEGORY_MM,
 			objectTableHashFn, objectTableHashEqualFn, NULL, NULL);
+#endif
 //	 
 
 //OMR finished.
@@ -405,6 +432,7 @@ Universe::~Universe() {
         delete(compiler);
     if (symboltable) 
         delete(symboltable);
+    delete[] globals;
 
 	// check done inside
     Heap::DestroyHeap();
@@ -456,6 +484,12 @@ void Universe::InitializeGlobals() {
     LoadSystemClass(objectClass);
 //    
     LoadSystemClass(classClass);
+    // Object's class side was compiled before Class had its fields, so the
+    // slot indices of its class-side fields are off; compile it once more now
+    // that the layout it builds on is known
+    if (objectClass->GetClass()->GetInstanceFields()
+            ->GetNumberOfIndexableFields() > 0)
+        LoadSystemClass(objectClass);
 //    
     LoadSystemClass(metaClassClass);
 //    
@@ -471,6 +505,10 @@ void Universe::InitializeGlobals() {
     LoadSystemClass(doubleClass);
 //    
     blockClass = LoadClass(_UNIVERSE->SymbolForChars("Block"));
+    //the classes of blocks with up to two parameters, as created by NewBlock
+    block1Class = GetBlockClassWithArgs(1);
+    block2Class = GetBlockClassWithArgs(2);
+    block3Class = GetBlockClassWithArgs(3);
 
     trueObject = NewInstance(_UNIVERSE->LoadClass(_UNIVERSE->SymbolForChars("True")));
     falseObject = NewInstance(_UNIVERSE->LoadClass(_UNIVERSE->SymbolForChars("False")));
@@ -515,39 +553,66 @@ pVMClass Universe::GetBlockClassWithArgs( int numberOfArguments) {
 
 
 pVMObject Universe::GetGlobal( pVMSymbol name) {
-//    if (HasGlobal(name))
-//        return (pVMObject)globals[name];
-//
-//    return NULL;
-	//Try to find them in the rootTable for OMR
-	return HasGlobal(name);
-}
-//
-//RootEntry rEntry = {name->GetChars(),(omrobjectptr_t)val};
-//RootEntry *entryInTable = (RootEntry *)hashTableAdd(exampleVM.rootTable, &rEntry);
-//if (NULL == entryInTable) {
-//	OMRPORT_ACCESS_FROM_OMRVM(exampleVM._omrVM);
-//	omrtty_printf("failed to add new root to root table!\n");
-//}
-///* update entry if it already exists in table */
-//entryInTable->rootPtr = (omrobjectptr_t)val;
+    return HasGlobal(name);
+}
 
 
 pVMObject  Universe::HasGlobal( pVMSymbol name) {
-//    if (globals[name] != NULL) return true;
-//    else return false;
-	//Try to find them in the root table for OMR.
-	J9HashTableState state;
-	RootEntry *rEntry = NULL;
-	rEntry = (RootEntry *)hashTableStartDo(exampleVM.rootTable, &state);
-	while (rEntry != NULL) {
-		//_markingScheme->markObject(env, rEntry->rootPtr);
-		if(!strcmp(rEntry->name,name->GetChars())){
-			return (pVMObject)rEntry->rootPtr;
-		}
-		rEntry = (RootEntry *)hashTableNextDo(&state);
-	}
-	return NULL;
+    pVMArray association = lookupGlobalAssociation(name);
+    if (association == NULL) return NULL;
+    return association->GetStartOfAdditionalPoint()[ASSOCIATION_VALUE];
+}
+
+
+pVMArray Universe::lookupGlobalAssociation( pVMSymbol name) const {
+    int mask = globalsCapacity - 1;
+    for (int i = name->GetHash() & mask; globals[i] != NULL; 
+                                         i = (i + 1) & mask) {
+        pVMObject* entry = globals[i]->GetStartOfAdditionalPoint();
+        if (entry[ASSOCIATION_KEY] == (pVMObject)name) return globals[i];
+    }
+    return NULL;
+}
+
+
+pVMArray Universe::GetGlobalAssociation( pVMSymbol name) {
+    pVMArray association = lookupGlobalAssociation(name);
+    if (association != NULL) return association;
+
+    //enter an unbound association, the table is a GC root
+    association = NewArray(2);
+    association->SetIndexableField(ASSOCIATION_KEY, (pVMObject)name);
+    (*association)[ASSOCIATION_VALUE] = NULL;
+
+    if (2 * (numberOfGlobals + 1) > globalsCapacity) growGlobals();
+    int mask = globalsCapacity - 1;
+    int i = name->GetHash() & mask;
+    while (globals[i] != NULL) i = (i + 1) & mask;
+    globals[i] = association;
+    ++numberOfGlobals;
+
+    return association;
+}
+
+
+void Universe::growGlobals() {
+    pVMArray* oldGlobals = globals;
+    int oldCapacity = globalsCapacity;
+
+    globalsCapacity *= 2;
+    globals = new pVMArray[globalsCapacity];
+    memset(globals, 0, globalsCapacity * sizeof(pVMArray));
+
+    int mask = globalsCapacity - 1;
+    for (int j = 0; j < oldCapacity; ++j) {
+        if (oldGlobals[j] == NULL) continue;
+        pVMSymbol name = (pVMSymbol)
+                oldGlobals[j]->GetStartOfAdditionalPoint()[ASSOCIATION_KEY];
+        int i = name->GetHash() & mask;
+        while (globals[i] != NULL) i = (i + 1) & mask;
+        globals[i] = oldGlobals[j];
+    }
+    delete[] oldGlobals;
 }
 
 
@@ -591,8 +656,10 @@ void Universe::InitializeSystemClass( pVMClass systemClass,
 
 
 pVMClass Universe::LoadClass( pVMSymbol name) {
-   if (HasGlobal(name))
-       return dynamic_cast<pVMClass>(GetGlobal(name));
+   if (HasGlobal(name)) {
+       pVMObject global = GetGlobal(name);
+       return IS_TAGGED(global) ? NULL : dynamic_cast<pVMClass>(global);
+   }
 
    pVMClass result = LoadClassBasic(name, NULL);
 
@@ -610,6 +677,9 @@ pVMClass Universe::LoadClass( pVMSymbol name) {
 
 pVMClass Universe::LoadClassBasic( pVMSymbol name, pVMClass systemClass) {
 //	
+    // compiling installs classes and globals that a restarted bytecode
+    // would install again
+    Heap::PreventRetry();
     StdString s_name = name->GetStdString();
     //cout << s_name.c_str() << endl;
     pVMClass result;
@@ -635,8 +705,9 @@ pVMClass Universe::LoadClassBasic( pVMSymbol name, pVMClass systemClass) {
 
 
 pVMClass Universe::LoadShellClass( StdString& stmt) {
+    Heap::PreventRetry();
     pVMClass result = compiler->CompileClassString(stmt, NULL);
-     if(dumpBytecodes)
+     if(dumpBytecodes && result)
          Disassembler::Dump(result);
     return result;
 }
@@ -672,7 +743,7 @@ pVMArray Universe::NewArrayFromArgv( const vector<StdString>& argv) const {
     int j = 0;
     for (vector<StdString>::const_iterator i = argv.begin();
          i != argv.end(); ++i) {
-        (*result)[j] =  NewString(*i);
+        result->SetIndexableField(j, NewString(*i));
         ++j;
     }
 
@@ -689,7 +760,7 @@ pVMArray Universe::NewArrayList(ExtendedList<pVMObject>& list ) const {
         for (int i = 0; i < size; ++i) {
             pVMObject elem = list.Get(i);
             
-            (*result)[i] = elem;
+            result->SetIndexableField(i, elem);
         }
     }
     return result;
@@ -705,12 +776,22 @@ pVMBigInteger Universe::NewBigInteger( int64_t value) const {
 
 
 pVMBlock Universe::NewBlock( pVMMethod method, pVMFrame context, int arguments) {
+    //the block may outlive its context, which has to be on the heap
+    context = interpreter->ReifyFrame(context);
+
+    pVMClass blockClassWithArgs;
+    switch (arguments) {
+        case 1:  blockClassWithArgs = block1Class; break;
+        case 2:  blockClassWithArgs = block2Class; break;
+        case 3:  blockClassWithArgs = block3Class; break;
+        default: blockClassWithArgs = GetBlockClassWithArgs(arguments);
+    }
+
     pVMBlock result = new (_HEAP) VMBlock;
-    result->SetClass(this->GetBlockClassWithArgs(arguments));
+    result->SetClass(blockClassWithArgs);
 
     result->SetMethod(method);
     result->SetContext(context);
-    this->SetGlobal(method->GetSignature(),(pVMObject)result);
     return result;
 }
 
@@ -723,7 +804,6 @@ pVMClass Universe::NewClass( pVMClass classOfClass)  {
     else result = new (_HEAP) VMClass;
 
     result->SetClass(classOfClass);
-    this->SetGlobal(SymbolForChars("NewClass"),(pVMObject)result);
     return result;
 }
 
@@ -751,8 +831,6 @@ pVMFrame Universe::NewFrame( pVMFrame previousFrame, pVMMethod method)  {
 
     result->ResetStackPointer();
     result->SetBytecodeIndex(0);
-    //zg.don't we need to set it as global?
-   this->SetGlobal(frameClass->GetName(),(pVMObject)result);
     return result;
 }
 
@@ -769,6 +847,8 @@ pVMObject Universe::NewInstance( pVMClass  classOfInstance) const {
 }
 
 pVMInteger Universe::NewInteger( int32_t value) const {
+    if (CAN_TAG_INTEGER(value)) return TAG_INTEGER(value);
+
     pVMInteger result = new (_HEAP) VMInteger(value);
     result->SetClass(integerClass);
     return result;
@@ -786,17 +866,20 @@ pVMClass Universe::NewMetaclassClass() const {
 
 
 pVMMethod Universe::NewMethod( pVMSymbol signature, 
-                    size_t numberOfBytecodes, size_t numberOfConstants)  {
-    //Method needs space for the bytecodes and the pointers to the constants
-    int additionalBytes = numberOfBytecodes + 
-                numberOfConstants*sizeof(pVMObject);
+                    size_t numberOfBytecodes, size_t numberOfConstants,
+                    size_t numberOfSendSites)  {
+    //Method needs space for the bytecodes, the pointers to the constants
+    //and the inline caches of its send sites
+    int additionalBytes = 
+                VMMethod::GetBytecodeSpace(numberOfBytecodes) + 
+                numberOfConstants*sizeof(pVMObject) +
+                numberOfSendSites*sizeof(InlineCache);
     pVMMethod result = new (_HEAP,additionalBytes) 
-                VMMethod(numberOfBytecodes, numberOfConstants);
+                VMMethod(numberOfBytecodes, numberOfConstants,
+                         numberOfSendSites);
     result->SetClass(methodClass);
 
     result->SetSignature(signature);
-    //zg.don't we need to set it as global?
-     this->SetGlobal(signature,(pVMObject)result);
     return result;
 }
 
@@ -814,13 +897,17 @@ pVMString Universe::NewString( const char* str) const {
 }
 
 pVMSymbol Universe::NewSymbol( const StdString& str) {
-    return NewSymbol(str.c_str());
+    return NewSymbol(str.c_str(), str.length());
 }
 
 pVMSymbol Universe::NewSymbol( const char* str ) {
-    //symbol needs space for str.length characters plus one byte for '\0'
-    int additionalBytes = strlen(str) + 1;
-    pVMSymbol result = new (_HEAP, additionalBytes) VMSymbol(str);
+    return NewSymbol(str, strlen(str));
+}
+
+pVMSymbol Universe::NewSymbol( const char* str, size_t length ) {
+    //symbol needs space for length characters plus one byte for '\0'
+    int additionalBytes = length + 1;
+    pVMSymbol result = new (_HEAP, additionalBytes) VMSymbol(str, length);
     result->SetClass(symbolClass);
 
     symboltable->insert(result);
@@ -836,41 +923,51 @@ pVMClass Universe::NewSystemClass()  {
     pVMClass mclass = systemClass->GetClass();
     
     mclass->SetClass(metaClassClass);
-    this->SetGlobal(SymbolForChars("SystemClass"),(pVMObject)systemClass);
     return systemClass;
 }
 
 
 pVMSymbol Universe::SymbolFor( const StdString& str) {
-    return SymbolForChars(str.c_str());
+    return SymbolForChars(str.c_str(), str.length());
     
 }
 
 
 pVMSymbol Universe::SymbolForChars( const char* str) {
-    pVMSymbol result = symboltable->lookup(str);
+    return SymbolForChars(str, strlen(str));
+}
+
+
+pVMSymbol Universe::SymbolForChars( const char* str, size_t length) {
+    pVMSymbol result = symboltable->lookup(str, length);
     
     return (result != NULL) ?
            result :
-           NewSymbol(str);
+           NewSymbol(str, length);
 }
 
 
 void Universe::SetGlobal(pVMSymbol name, VMObject *val) {
-
-    //globals[name] = val;
-	RootEntry rEntry = {name->GetChars(),(omrobjectptr_t)val};
-	RootEntry *entryInTable = (RootEntry *)hashTableAdd(exampleVM.rootTable, &rEntry);
-	if (NULL == entryInTable) {
-		OMRPORT_ACCESS_FROM_OMRVM(exampleVM._omrVM);
-		omrtty_printf("failed to add new root to root table!\n");
-	}
-	/* update entry if it already exists in table */
-	entryInTable->rootPtr = (omrobjectptr_t)val;
-
+    pVMArray association = GetGlobalAssociation(name);
+    association->SetIndexableField(ASSOCIATION_VALUE, val);
 }
 
 void Universe::FullGC() {
     heap->FullGC();
 }
 
+
+void Universe::WalkRoots(RootWalker walk, void* data) {
+    for (int i = 0; i < globalsCapacity; ++i) {
+        if (globals[i] != NULL) walk((pVMObject*)&globals[i], data);
+    }
+
+    int count = sizeof(wellKnownObjects) / sizeof(wellKnownObjects[0]);
+    for (int i = 0; i < count; ++i) {
+        if (*wellKnownObjects[i] != NULL) walk(wellKnownObjects[i], data);
+    }
+
+    if (symboltable != NULL) symboltable->WalkSymbols(walk, data);
+    if (interpreter != NULL) interpreter->WalkFrames(walk, data);
+}
+
@@ -60,9 +60,17 @@ class SourcecodeCompiler;
 //Convenience macro for Singleton access
 #define _UNIVERSE Universe::GetUniverse()
 
+//A global is bound in an association, a VMArray holding its name and value.
+//Methods refer to the association, so reading a global is a single load.
+//Globals that are referenced but not defined yet have a NULL value.
+#define ASSOCIATION_KEY 0
+#define ASSOCIATION_VALUE 1
+
 // for runtime debug
 extern short dumpBytecodes;
 extern short gcVerbosity;
+extern short profileBytecodes;
+extern short optimizeBytecodes;
 
 //global VMObjects
 extern pVMObject nilObject;
@@ -84,6 +92,9 @@ extern pVMClass primitiveClass;
 extern pVMClass stringClass;
 extern pVMClass systemClass;
 extern pVMClass blockClass;
+extern pVMClass block1Class;
+extern pVMClass block2Class;
+extern pVMClass block3Class;
 extern pVMClass doubleClass;
 
 using namespace std;
@@ -99,9 +110,6 @@ public:
     static void Quit(int);
     static void ErrorExit(const char*);
 
-    //Globals accessor (only for GC, could be considered be 
-    //declared as a private friend method for the GC)
-	map<pVMSymbol, pVMObject>  GetGlobals() {return globals;}
 	Heap* GetHeap() {return heap;}
     Interpreter* GetInterpreter() {return interpreter;}
 
@@ -111,6 +119,7 @@ public:
 
     pVMSymbol     SymbolFor(const StdString&);
     pVMSymbol     SymbolForChars(const char*);
+    pVMSymbol     SymbolForChars(const char*, size_t);
 
     //VMObject instanciation methods. These should probably be refactored to a new class
     pVMArray      NewArray(int) const;
@@ -119,7 +128,7 @@ public:
     pVMBlock      NewBlock(pVMMethod, pVMFrame, int);
     pVMClass      NewClass(pVMClass) ;
     pVMFrame      NewFrame(pVMFrame, pVMMethod) ;
-    pVMMethod     NewMethod(pVMSymbol, size_t, size_t) ;
+    pVMMethod     NewMethod(pVMSymbol, size_t, size_t, size_t = 0) ;
     pVMObject     NewInstance(pVMClass) const;
     pVMInteger    NewInteger(int32_t) const;
     pVMBigInteger NewBigInteger(int64_t) const;
@@ -127,6 +136,7 @@ public:
     pVMClass      NewMetaclassClass(void) const;
     pVMString     NewString(const StdString&) const;
     pVMSymbol     NewSymbol(const StdString&);
+    pVMSymbol     NewSymbol(const char*, size_t);
     pVMString     NewString(const char*) const;
     pVMSymbol     NewSymbol(const char*);
     pVMClass      NewSystemClass(void) ;
@@ -137,6 +147,7 @@ public:
     void          SetGlobal(pVMSymbol name, pVMObject val);
    // bool          HasGlobal(pVMSymbol);
     pVMObject HasGlobal(pVMSymbol);
+    pVMArray      GetGlobalAssociation(pVMSymbol);
     void          InitializeGlobals();
     pVMClass      GetBlockClass(void) const;
     pVMClass      GetBlockClassWithArgs(int);
@@ -147,6 +158,9 @@ public:
     pVMClass      LoadShellClass(StdString&);
     
     void          FullGC();
+    //calls walk for every root of the object graph: the globals, the
+    //objects the VM refers to directly, the symbols and the frame chain
+    void          WalkRoots(RootWalker walk, void* data);
     
     Universe();
 	~Universe();
@@ -163,11 +177,17 @@ private:
 	
 
     void initialize(int, char**);
+    pVMArray lookupGlobalAssociation(pVMSymbol) const;
+    void growGlobals();
 
 	Heap* heap;
 	uintptr_t heapSize;
 	//int heapSize;
-	map<pVMSymbol, pVMObject> globals;
+	//open addressing hash table of the global associations, keyed by
+	//the interned name
+	pVMArray* globals;
+	int globalsCapacity;
+	int numberOfGlobals;
     vector<StdString> classPath;
     
     Symboltable* symboltable;
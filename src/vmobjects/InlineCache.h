@@ -0,0 +1,86 @@
+#pragma once
+#ifndef INLINECACHE_H_
+#define INLINECACHE_H_
+
+/*
+ *
+ *
+Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+http://www.hpi.uni-potsdam.de/swa/
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+  */
+
+
+
+#include "../misc/defs.h"
+#include "ObjectFormats.h"
+#include "VMClass.h"
+
+class VMInvokable;
+
+/*
+ **************************************************************
+ * InlineCache remembers the result of method lookups at one
+ * send site of a method.
+ * The cache starts out empty, becomes monomorphic after the
+ * first lookup and polymorphic with up to InlineCacheSize
+ * receiver classes. Beyond that the site is megamorphic and
+ * always falls back to the full lookup.
+ * All caches are flushed lazily whenever a class changes its
+ * invokables or superclass, which bumps the lookup epoch of VMClass.
+ **************************************************************
+ */
+#define InlineCacheSize 4
+#define InlineCacheMegamorphic (-1)
+
+// sites beyond this number share no cache and always do a full lookup
+#define NoInlineCache 0xFF
+
+class InlineCache {
+public:
+    void                Initialize();
+    inline pVMInvokable Lookup(pVMClass receiverClass);
+    void                Update(pVMClass receiverClass, pVMInvokable invokable);
+
+    bool                IsMegamorphic() const 
+                            { return entries == InlineCacheMegamorphic; };
+
+    // the cached classes and invokables are seen by the GC, so that
+    // cached objects stay alive as long as they are in the cache
+    pVMClass            classes[InlineCacheSize];
+    pVMInvokable        invokables[InlineCacheSize];
+private:
+    int32_t             epoch;
+    int32_t             entries;
+};
+
+
+pVMInvokable InlineCache::Lookup(pVMClass receiverClass) {
+    if (epoch != VMClass::GetLookupEpoch()) {
+        Initialize();
+        return NULL;
+    }
+    for (int i = 0; i < entries; ++i)
+        if (classes[i] == receiverClass) return invokables[i];
+    return NULL;
+}
+
+#endif
@@ -44,6 +44,40 @@ THE SOFTWARE.
 #define pVMString VMString* 
 #define pVMSymbol VMSymbol* 
 
+class VMObject;
+
+/*
+ * The GC walks the roots, the slots outside of the heap that refer to
+ * objects, with a callback that gets the address of the slot, so that a
+ * moving collector is able to update it.
+ */
+typedef void (*RootWalker)(pVMObject* slot, void* data);
+
+/*
+ * SmallIntegers are stored directly in the object pointer: a pointer with
+ * the lowest bit set is not a heap reference but an integer shifted left
+ * by one. Heap objects are always at least pointer aligned, so the bit is
+ * free. Values outside of the tagged range are boxed in a VMInteger.
+ *
+ * CLASS_OF has to be used instead of GetClass() whenever the object might
+ * be an integer, INT_VAL instead of GetEmbeddedInteger().
+ */
+#define VMTAGGEDINTEGER_MAX \
+    ((intptr_t)((((uintptr_t)1) << (sizeof(intptr_t) * 8 - 2)) - 1))
+#define VMTAGGEDINTEGER_MIN (-VMTAGGEDINTEGER_MAX - 1)
+
+#define IS_TAGGED(X) ((((intptr_t)(X)) & 1) != 0)
+#define CAN_TAG_INTEGER(X) (((intptr_t)(X)) >= VMTAGGEDINTEGER_MIN && \
+                            ((intptr_t)(X)) <= VMTAGGEDINTEGER_MAX)
+#define TAG_INTEGER(X) \
+    ((pVMInteger)((((uintptr_t)(intptr_t)(X)) << 1) | 1))
+#define UNTAG_INTEGER(X) ((int32_t)(((intptr_t)(X)) >> 1))
+
+#define INT_VAL(X) (IS_TAGGED(X) ? UNTAG_INTEGER(X) \
+                                 : ((pVMInteger)(X))->GetEmbeddedInteger())
+#define CLASS_OF(X) (IS_TAGGED(X) ? integerClass \
+                                  : ((pVMObject)(X))->GetClass())
+
 
 
 
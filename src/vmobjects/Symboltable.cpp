@@ -27,25 +27,73 @@ THE SOFTWARE.
 
 #include "Symboltable.h"
 
+#include <string.h>
 
-pVMSymbol Symboltable::lookup(const char* restrict) {
-    return symtab[StdString(restrict)];
-}
+#define INITIAL_CAPACITY 1024
 
 
-pVMSymbol Symboltable::lookup(const StdString& restrict) {
-    return symtab[restrict];
+pVMSymbol Symboltable::lookup(const char* chars, size_t length) {
+    return symbols[indexOf(chars, length, VMSymbol::HashChars(chars, length))];
 }
 
 
 void      Symboltable::insert(pVMSymbol sym) {
-    symtab[sym->GetStdString()] = sym;
+    //keep the table at most three quarters full
+    if (4 * (count + 1) > 3 * capacity) grow();
+    
+    symbols[indexOf(sym->GetChars(), sym->GetStringLength(),
+                    sym->GetStringHash())] = sym;
+    count++;
+}
+
+
+void      Symboltable::WalkSymbols(RootWalker walk, void* data) {
+    for (size_t i = 0; i < capacity; ++i)
+        if (symbols[i] != NULL) walk((pVMObject*)&symbols[i], data);
+}
+
+
+size_t    Symboltable::indexOf(const char* chars, size_t length,
+                               uint32_t hash) const {
+    //the slot of the symbol with these characters, or the empty slot where it
+    //belongs
+    size_t mask = capacity - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        pVMSymbol sym = symbols[i];
+        if (sym == NULL) return i;
+        if (sym->GetStringHash() == hash &&
+            (size_t)sym->GetStringLength() == length &&
+            memcmp(sym->GetChars(), chars, length) == 0)
+            return i;
+    }
+}
+
+
+void      Symboltable::grow() {
+    pVMSymbol* old = symbols;
+    size_t oldCapacity = capacity;
+    
+    capacity *= 2;
+    symbols = new pVMSymbol[capacity]();
+    for (size_t i = 0; i < oldCapacity; ++i) {
+        pVMSymbol sym = old[i];
+        if (sym == NULL) continue;
+        size_t mask = capacity - 1;
+        size_t j = sym->GetStringHash() & mask;
+        while (symbols[j] != NULL) j = (j + 1) & mask;
+        symbols[j] = sym;
+    }
+    delete[] old;
 }
 
 
 Symboltable::Symboltable() {
+    capacity = INITIAL_CAPACITY;
+    count = 0;
+    symbols = new pVMSymbol[capacity]();
 }
 
 
 Symboltable::~Symboltable() {
+    delete[] symbols;
 }
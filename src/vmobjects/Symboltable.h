@@ -32,16 +32,34 @@ THE SOFTWARE.
 #include "VMSymbol.h"
 #include "../misc/defs.h"
 
+/*
+ * The symbol table is an open addressing hash table of the interned symbols,
+ * organized by the string hashes the symbols keep. Lookups compare hashes and
+ * characters in place and never allocate.
+ *
+ * Every interned symbol is a GC root, since the compiler and the primitives
+ * hold symbols where the GC doesn't see them, so symbols are never reclaimed.
+ * As a slot only depends on the hash stored in its symbol, a collector may
+ * move symbols without rehashing. Dead symbols can't simply be cleared from
+ * their slots though: that would cut the probe sequences of the symbols
+ * placed after them.
+ */
 class Symboltable {
 public:
-    pVMSymbol lookup(const char* restrict);
-    pVMSymbol lookup(const StdString& restrict);
+    pVMSymbol lookup(const char* chars, size_t length);
     void      insert(pVMSymbol);
+    //interned symbols are GC roots
+    void      WalkSymbols(RootWalker walk, void* data);
 
     Symboltable();
     ~Symboltable();
 private:
-    map<StdString, pVMSymbol> symtab;
+    size_t    indexOf(const char* chars, size_t length, uint32_t hash) const;
+    void      grow();
+
+    pVMSymbol* symbols;
+    size_t     capacity; //a power of two
+    size_t     count;
 };
 
 #endif
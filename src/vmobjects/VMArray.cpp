@@ -38,9 +38,8 @@ VMArray::VMArray(int size, int nof) : VMObject(nof + VMArrayNumberOfFields) {
     _HEAP->StartUninterruptableAllocation();
 	//
     for (int i = 0; i < size ; ++i) {
-        (*this)[i] = nilObject;
+        this->SetIndexableField(i, nilObject);
     }
-    strcpy(objectType,"VMArray");
     _HEAP->EndUninterruptableAllocation();
 
 }
@@ -50,7 +49,7 @@ pVMArray VMArray::CopyAndExtendWith(pVMObject item) const {
     size_t fields = GetNumberOfIndexableFields();
 	pVMArray result = _UNIVERSE->NewArray(fields+1);
     this->CopyIndexableFieldsTo(result);
-	(*result)[fields] = item;
+	result->SetIndexableField(fields, item);
 	return result;
 }
 
@@ -66,9 +65,14 @@ pVMObject& VMArray::operator[](int idx) const {
 }
 
 
+void VMArray::SetIndexableField(int idx, pVMObject item) {
+    (*this)[idx] = item;
+}
+
+
 void VMArray::CopyIndexableFieldsTo(pVMArray to) const {
 	for (int i = 0; i < this->GetNumberOfIndexableFields(); ++i) {
-        (*to)[i] = (*this)[i];
+        to->SetIndexableField(i, (*this)[i]);
 	}
 	
 }
@@ -81,7 +85,7 @@ void VMArray::MarkReferences() {
     if (gcfield) return;
     VMObject::MarkReferences();
 	for (int i = 0 ; i < GetNumberOfIndexableFields() ; ++i) {
-		if (theEntries(i) != NULL)
+		if (theEntries(i) != NULL && !IS_TAGGED(theEntries(i)))
 			theEntries(i)->MarkReferences();
 	}
     
@@ -43,6 +43,7 @@ public:
 	void        CopyIndexableFieldsTo(pVMArray) const;
 
 	pVMObject& operator[](int idx) const;
+	void        SetIndexableField(int idx, pVMObject item);
 
 private:
     static const int VMArrayNumberOfFields;
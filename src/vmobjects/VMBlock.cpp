@@ -35,7 +35,6 @@ THE SOFTWARE.
 const int VMBlock::VMBlockNumberOfFields = 2; 
 
 VMBlock::VMBlock() : VMObject(VMBlockNumberOfFields) {
-	 strcpy(objectType,"VMBlock");
 }
 
 void VMBlock::SetMethod(pVMMethod bMethod) {
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "VMInvokable.h"
 #include "VMPrimitive.h"
 #include "PrimitiveRoutine.h"
+#include "VMInteger.h"
 
 #include <fstream>
 #include <typeinfo>
@@ -61,15 +62,36 @@ THE SOFTWARE.
 // as in AClass::anInstanceMethod_
 
 
-const int VMClass::VMClassNumberOfFields = 4; 
+/*
+ * The method dictionary is an open addressing hash table kept in a VMArray.
+ * Entry 0 holds the lookup epoch the table was built in, followed by pairs
+ * of signature and invokable. Signatures are interned, so they are compared
+ * by identity. A nil signature marks an empty slot.
+ */
+#define DICTIONARY_EPOCH 0
+#define DICTIONARY_KEY(i) (1 + 2 * (i))
+#define DICTIONARY_VALUE(i) (2 + 2 * (i))
+#define DICTIONARY_MIN_CAPACITY 8
+
+
+const int VMClass::VMClassNumberOfFields = 5; 
+
+int32_t VMClass::lookupEpoch = 0;
 
 VMClass::VMClass() : VMObject(VMClassNumberOfFields) {
-	 strcpy(objectType,"VMClass");
+	 methodDictionary = (pVMArray)nilObject;
 }
 
 
 VMClass::VMClass( int numberOfFields ) : VMObject(numberOfFields + VMClassNumberOfFields) {
-	 strcpy(objectType,"VMClass");
+	 methodDictionary = (pVMArray)nilObject;
+}
+
+
+void VMClass::SetSuperClass(pVMClass sup) {
+	superClass = sup;
+    //lookups along the old superclass chain are no longer valid
+    VMClass::InvalidateLookups();
 }
 
 
@@ -98,6 +120,8 @@ bool VMClass::AddInstanceInvokable(pVMObject ptr) {
 	}
     //it's a new invokable so we need to expand the invokables array.
     instanceInvokables = instanceInvokables->CopyAndExtendWith(ptr);
+    //the new invokable may hide one of a superclass
+    VMClass::InvalidateLookups();
 
 	return true;
 }
@@ -125,6 +149,7 @@ pVMSymbol VMClass::GetInstanceFieldName(int index) const {
 void      VMClass::SetInstanceInvokables(pVMArray invokables) {
 //	
 	instanceInvokables = invokables;
+    VMClass::InvalidateLookups();
 	int numofInvokables  =  this->GetNumberOfInstanceInvokables();
 //	
     for (int i = 0; i <numofInvokables; ++i) {
@@ -155,7 +180,8 @@ pVMObject VMClass::GetInstanceInvokable(int index) const {
 
 
 void      VMClass::SetInstanceInvokable(int index, pVMObject invokable) {
-	(*instanceInvokables)[index] = invokable;
+	instanceInvokables->SetIndexableField(index, invokable);
+    VMClass::InvalidateLookups();
     if (invokable != nilObject) {
         pVMInvokable inv = dynamic_cast<pVMInvokable>( invokable );
         inv->SetHolder(this);
@@ -164,29 +190,78 @@ void      VMClass::SetInstanceInvokable(int index, pVMObject invokable) {
 
 
 pVMObject VMClass::LookupInvokable(pVMSymbol name) const {
-    pVMInvokable invokable = NULL;
-    for (int i = 0; i < GetNumberOfInstanceInvokables(); ++i) {
-        invokable = (pVMInvokable)(GetInstanceInvokable(i));
-        if( NULL == invokable){
-        	break;
+    pVMArray dictionary = methodDictionary;
+    if (dictionary == NULL || dictionary == (pVMArray)nilObject ||
+        INT_VAL((*dictionary)[DICTIONARY_EPOCH])
+                                                        != lookupEpoch) {
+        dictionary = const_cast<VMClass*>(this)->buildMethodDictionary();
+    }
+
+    pVMObject* entries = dictionary->GetStartOfAdditionalPoint();
+    int mask = (dictionary->GetNumberOfIndexableFields() - 1) / 2 - 1;
+    for (int i = name->GetHash() & mask; ; i = (i + 1) & mask) {
+        pVMObject key = entries[DICTIONARY_KEY(i)];
+        if (key == (pVMObject)name) return entries[DICTIONARY_VALUE(i)];
+        if (key == nilObject) return NULL;
+    }
+}
+
+
+pVMArray VMClass::buildMethodDictionary() {
+    // own invokables are entered first, so they hide inherited ones
+    int count = 0;
+    for (pVMClass cl = this; cl != NULL; 
+         cl = cl->HasSuperClass() ? cl->superClass : NULL) {
+        count += cl->GetNumberOfInstanceInvokables();
+    }
+    int capacity = DICTIONARY_MIN_CAPACITY;
+    while (capacity < 2 * count) capacity *= 2;
+
+    _HEAP->StartUninterruptableAllocation();
+    pVMArray dictionary = _UNIVERSE->NewArray(1 + 2 * capacity);
+    dictionary->SetIndexableField(DICTIONARY_EPOCH,
+                            (pVMObject)_UNIVERSE->NewInteger(lookupEpoch));
+
+    for (pVMClass cl = this; cl != NULL; 
+         cl = cl->HasSuperClass() ? cl->superClass : NULL) {
+        for (int i = 0; i < cl->GetNumberOfInstanceInvokables(); ++i) {
+            pVMInvokable invokable = 
+                            (pVMInvokable)(cl->GetInstanceInvokable(i));
+            if (invokable == NULL || invokable == (pVMInvokable)nilObject)
+                continue;
+            addToMethodDictionary(dictionary, capacity, invokable);
         }
-        if (invokable->GetSignature() == name) 
-            return (pVMObject)(invokable);
     }
-    invokable = NULL;
-    //look in super class
-    if (this->HasSuperClass())  {
-        invokable = (pVMInvokable)(this->superClass->LookupInvokable(name));
+    methodDictionary = dictionary;
+    _HEAP->EndUninterruptableAllocation();
+
+    return dictionary;
+}
+
+
+void VMClass::addToMethodDictionary(pVMArray dictionary, int capacity,
+                                    pVMInvokable invokable) const {
+    pVMSymbol signature = invokable->GetSignature();
+    pVMObject* entries = dictionary->GetStartOfAdditionalPoint();
+    int mask = capacity - 1;
+    for (int i = signature->GetHash() & mask; ; i = (i + 1) & mask) {
+        pVMObject key = entries[DICTIONARY_KEY(i)];
+        if (key == (pVMObject)signature) return;
+        if (key == nilObject) {
+            dictionary->SetIndexableField(DICTIONARY_KEY(i),
+                                          (pVMObject)signature);
+            dictionary->SetIndexableField(DICTIONARY_VALUE(i),
+                                          (pVMObject)invokable);
+            return;
+        }
     }
-	return (pVMObject)(invokable);
 }
 
 
 int       VMClass::LookupFieldIndex(pVMSymbol name) const {
-    for (int i = 0; i <=GetNumberOfInstanceFields(); ++i) { 
-        //even with GetNumberOfInstanceFields == 0 there is the class field 
-        if (name == this->GetInstanceFieldName(i) ||
-            name->GetStdString() == this->GetInstanceFieldName(i)->GetStdString()) 
+    // Object declares the class field, so it is counted as well
+    for (int i = 0; i < GetNumberOfInstanceFields(); ++i) { 
+        if (name == this->GetInstanceFieldName(i)) 
                 return i;
     }
 	return -1;
@@ -44,6 +44,7 @@ THE SOFTWARE.
 class VMSymbol;
 class VMArray;
 class VMPrimitive;
+class VMInvokable;
 class ClassGenerationContext;
 
 class VMClass : public VMObject {
@@ -52,7 +53,7 @@ public:
     VMClass(int numberOfFields);
 
 	virtual inline pVMClass  GetSuperClass() const; 
-    virtual inline void      SetSuperClass(pVMClass); 
+    virtual void             SetSuperClass(pVMClass); 
     virtual bool             HasSuperClass() const;  
     virtual inline pVMSymbol GetName() const; 
     virtual inline void      SetName(pVMSymbol);  
@@ -71,6 +72,11 @@ public:
     virtual int       GetNumberOfInstanceFields() const; 
     virtual bool      HasPrimitives() const; 
     virtual void      LoadPrimitives(const vector<StdString>&);
+
+    // Method dictionaries are rebuilt lazily after any class changed its
+    // invokables or superclass, as inherited entries are flattened into them
+    static void       InvalidateLookups() { ++lookupEpoch; };
+    static int32_t    GetLookupEpoch() { return lookupEpoch; };
 	
 
 private:
@@ -89,12 +95,18 @@ private:
     
     int numberOfSuperInstanceFields() const;
 
+    pVMArray buildMethodDictionary();
+    void     addToMethodDictionary(pVMArray dictionary, int capacity,
+                                   pVMInvokable invokable) const;
+
 	pVMClass  superClass; 
     pVMSymbol name; 
     pVMArray  instanceFields; 
     pVMArray  instanceInvokables;
+    pVMArray  methodDictionary;
 
     static const int VMClassNumberOfFields;
+    static int32_t   lookupEpoch;
 };
 
 
@@ -103,11 +115,6 @@ pVMClass VMClass::GetSuperClass() const {
 }
 
 
-void VMClass::SetSuperClass(pVMClass sup) {
-	superClass = sup;
-}
-
-
 pVMSymbol VMClass::GetName()  const {
 	return name;
 }
@@ -45,27 +45,23 @@ VMEvaluationPrimitive::VMEvaluationPrimitive(int argc) :
                                &VMEvaluationPrimitive::evaluationRoutine));
     this->SetEmpty(false);
     this->numberOfArguments = _UNIVERSE->NewInteger(argc);
-    strcpy(objectType,"VMEvalPrim");
     _HEAP->EndUninterruptableAllocation();
 }
 
 
-int       VMEvaluationPrimitive::GetNumberOfMarkableFields() const
-{return GetNumberOfFields()- 2+1;}
-
-pVMObject       VMEvaluationPrimitive::GetMarkableFieldObj(int idx) const {
-	 int mfn = GetNumberOfMarkableFields();
-	 if(idx <mfn -1 ){
-		 return (pVMObject) FIELDS[idx];
-	 }else if (idx== mfn-1){		//This extra for this object.
-		 return (pVMObject)numberOfArguments;
-	 }else {
-		 return NULL;
-	 }
+int VMEvaluationPrimitive::GetReferenceMap(ReferenceRange* map) const {
+    //the number of arguments follows the raw fields of VMPrimitive
+    int ranges = VMPrimitive::GetReferenceMap(map);
+    map[ranges].start = (pVMObject*)&this->numberOfArguments;
+    map[ranges].length = 1;
+    map[ranges].count = 1;
+    map[ranges].stride = 0;
+    return ranges + 1;
 }
 void VMEvaluationPrimitive::MarkReferences() {
     VMPrimitive::MarkReferences();
-    this->numberOfArguments->MarkReferences();
+    if (!IS_TAGGED(this->numberOfArguments))
+        this->numberOfArguments->MarkReferences();
 }
 
 
@@ -99,7 +95,7 @@ void VMEvaluationPrimitive::evaluationRoutine(pVMObject object, pVMFrame frame){
     pVMEvaluationPrimitive self = (pVMEvaluationPrimitive) object;
 
      // Get the block (the receiver) from the stack
-    int numArgs = self->numberOfArguments->GetEmbeddedInteger();
+    int numArgs = INT_VAL(self->numberOfArguments);
     pVMBlock block = (pVMBlock) frame->GetStackElement(numArgs - 1);
     
     // Get the context of the block...
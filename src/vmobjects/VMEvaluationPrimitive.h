@@ -38,8 +38,7 @@ class VMFrame;
 class VMEvaluationPrimitive : public VMPrimitive {
 public:
     VMEvaluationPrimitive(int argc);
-    virtual pVMObject       GetMarkableFieldObj(int ) const;
-   virtual  int       GetNumberOfMarkableFields() const;
+    virtual int       GetReferenceMap(ReferenceRange* map) const;
     virtual void MarkReferences();
 private:
     static pVMSymbol computeSignatureString(int argc);
@@ -50,24 +50,28 @@ pVMFrame VMFrame::EmergencyFrameFrom( pVMFrame from, int extraLength ) {
     result->SetPreviousFrame(from->GetPreviousFrame());
     result->SetMethod(from->GetMethod());
     result->SetContext(from->GetContext());
-    result->stackPointer = from->GetStackPointer();
+    result->receiver = from->receiver;
+    result->stackPointer = from->stackPointer;
     result->bytecodeIndex = from->bytecodeIndex;
     result->localOffset = from->localOffset;
+    result->nativeStackOffset = from->nativeStackOffset;
 
     return result;
 }
 
 
-const int VMFrame::VMFrameNumberOfFields = 6; 
+//the raw fields are the last ones and take as many pointer sized slots
+//as they need
+const int VMFrame::VMFrameNumberOfRawFields = 
+    (4 * sizeof(int32_t) + sizeof(pVMObject) - 1) / sizeof(pVMObject);
+const int VMFrame::VMFrameNumberOfFields = 5 + VMFrameNumberOfRawFields; 
 
 VMFrame::VMFrame(int size, int nof) : VMArray(size, 
                                               nof + VMFrameNumberOfFields) {
-    _HEAP->StartUninterruptableAllocation();
-    this->localOffset = _UNIVERSE->NewInteger(0);
-    this->bytecodeIndex = _UNIVERSE->NewInteger(0);
-    this->stackPointer = _UNIVERSE->NewInteger(0);
-    strcpy(objectType,"VMFrame");
-    _HEAP->EndUninterruptableAllocation();
+    this->localOffset = 0;
+    this->bytecodeIndex = 0;
+    this->stackPointer = 0;
+    this->nativeStackOffset = 0;
 }
 
 pVMMethod VMFrame::GetMethod() const {
@@ -101,12 +105,13 @@ pVMFrame VMFrame::GetContextLevel(int lvl) {
 }
 
 
-pVMFrame VMFrame::GetOuterContext() {
-    pVMFrame current = this;
-    while (current->HasContext()) {
-        current = current->GetContext();
-    }
-    return current;
+void     VMFrame::SetContext(pVMFrame frm) {
+    this->context = frm;
+    if (frm == nilObject) return;
+    //a block's frame gets its context after its arguments, and shares the
+    //home context and self of the frame it is nested in
+    this->homeContext = frm->GetOuterContext();
+    this->receiver = frm->GetReceiver();
 }
 
 
@@ -115,31 +120,34 @@ int VMFrame::RemainingStackSize() const {
     // - 1 because the stack pointer points at the top entry,
     // so the next entry would be put at stackPointer+1
     return this->GetNumberOfIndexableFields() - 
-           stackPointer->GetEmbeddedInteger() - 1;
+           stackPointer - 1;
 }
 
 pVMObject VMFrame::Pop() {
-    int32_t sp = this->stackPointer->GetEmbeddedInteger();
-    this->stackPointer->SetEmbeddedInteger(sp-1);
-    return (*this)[sp];
+    return (*this)[this->stackPointer--];
 }
 
 
 void      VMFrame::Push(pVMObject obj) {
-    int32_t sp = this->stackPointer->GetEmbeddedInteger() + 1;
-    this->stackPointer->SetEmbeddedInteger(sp);
-    (*this)[sp] = obj; 
+    (*this)[++this->stackPointer] = obj; 
 }
 
 
 void VMFrame::PrintStack() const {
-    cout << "SP: " << this->stackPointer->GetEmbeddedInteger() << endl;
-   // for (int i = 0; i < this->GetNumberOfIndexableFields()+1; ++i) {
-    for (int i = 0; i < this->GetNumberOfIndexableFields(); ++i) {
+    cout << "SP: " << this->stackPointer << endl;
+    // slots above the stack pointer hold stale pointers the GC does not update
+    int length = this->GetNumberOfLiveFields();
+    for (int i = 0; i < length; ++i) {
         pVMObject vmo = (*this)[i];
         cout << i << ": ";
-        if (vmo == NULL) 
+        if (vmo == NULL) {
             cout << "NULL" << endl;
+            continue;
+        }
+        if (IS_TAGGED(vmo)) {
+            cout << "index: " << i << " integer:" << INT_VAL(vmo) << endl;
+            continue;
+        }
         if (vmo == nilObject) 
             cout << "NIL_OBJECT" << endl;
         if (vmo->GetClass() == NULL) 
@@ -157,46 +165,46 @@ void      VMFrame::ResetStackPointer() {
     // arguments are stored in front of local variables
     pVMMethod meth = this->GetMethod();
     size_t lo = meth->GetNumberOfArguments();
-    this->localOffset->SetEmbeddedInteger(lo);
+    this->localOffset = lo;
   
     // Set the stack pointer to its initial value thereby clearing the stack
     size_t numLocals = meth->GetNumberOfLocals();
-    this->stackPointer->SetEmbeddedInteger(lo + numLocals - 1);
+    this->stackPointer = lo + numLocals - 1;
 }
 
 
 int       VMFrame::GetBytecodeIndex() const {
-    return this->bytecodeIndex->GetEmbeddedInteger();
+    return this->bytecodeIndex;
 }
 
 
 void      VMFrame::SetBytecodeIndex(int index) {
-    this->bytecodeIndex->SetEmbeddedInteger(index);
+    this->bytecodeIndex = index;
 }
 
 
 pVMObject VMFrame::GetStackElement(int index) const {
-    int sp = this->stackPointer->GetEmbeddedInteger();
+    int sp = this->stackPointer;
     return (*this)[sp-index];
 }
 
 
 void      VMFrame::SetStackElement(int index, pVMObject obj) {
-    int sp = this->stackPointer->GetEmbeddedInteger();
+    int sp = this->stackPointer;
     (*this)[sp-index] = obj; 
 }
 
 
 pVMObject VMFrame::GetLocal(int index, int contextLevel) {
     pVMFrame context = this->GetContextLevel(contextLevel);
-    int32_t lo = context->localOffset->GetEmbeddedInteger();
+    int32_t lo = context->localOffset;
     return (*context)[lo+index];
 }
 
 
 void      VMFrame::SetLocal(int index, int contextLevel, pVMObject value) {
     pVMFrame context = this->GetContextLevel(contextLevel);
-    size_t lo = context->localOffset->GetEmbeddedInteger();
+    size_t lo = context->localOffset;
     (*context)[lo+index] = value; 
 }
 
@@ -233,12 +241,78 @@ void      VMFrame::CopyArgumentsFrom(pVMFrame frame) {
     int num_args = meth->GetNumberOfArguments();
     for(int i=0; i < num_args; ++i) {
         pVMObject stackElem = frame->GetStackElement(num_args - 1 - i);
-        (*this)[i] = stackElem;
+        this->SetIndexableField(i, stackElem);
     }
+    this->receiver = (*this)[0];
+}
+
+
+int32_t   VMFrame::GetNativeStackOffset() const {
+    return this->nativeStackOffset;
+}
+
+
+void      VMFrame::SetNativeStackOffset(int32_t offset) {
+    this->nativeStackOffset = offset;
+}
+
+
+void      VMFrame::WalkObjects(RootWalker walk, void* data) {
+    walk((pVMObject*)&this->clazz, data);
+    walk((pVMObject*)&this->context, data);
+    walk((pVMObject*)&this->method, data);
+    walk((pVMObject*)&this->homeContext, data);
+    walk(&this->receiver, data);
+
+    pVMObject* slots = this->GetStartOfAdditionalPoint();
+    int length = this->GetNumberOfLiveFields();
+    for (int i = 0; i < length; ++i)
+        walk(&slots[i], data);
+}
+
+
+int VMFrame::GetNumberOfLiveFields() const {
+    int32_t top = this->stackPointer;
+    Interpreter* interpreter = _UNIVERSE->GetInterpreter();
+    if (this == interpreter->GetPrimitiveFrame() &&
+        interpreter->GetPrimitiveStackPointer() > top)
+        top = interpreter->GetPrimitiveStackPointer();
+
+    int length = this->GetNumberOfIndexableFields();
+    return top < length ? top + 1 : length;
+}
+
+
+pVMObject* VMFrame::GetPreviousFrameSlot() {
+    return (pVMObject*)&this->previousFrame;
 }
 
 
 void VMFrame::MarkReferences() {
     if (gcfield) return;
-     VMArray::MarkReferences();
+    this->SetGCField(1);
+    ReferenceRunIterator runs(this);
+    pVMObject* slots;
+    int length;
+    while (runs.Next(slots, length)) {
+        for (int i = 0; i < length; ++i) {
+            pVMObject o = slots[i];
+            if (o != NULL && !IS_TAGGED(o)) o->MarkReferences();
+        }
+    }
+}
+
+
+int VMFrame::GetReferenceMap(ReferenceRange* map) const {
+    //the fields up to the raw ones
+    map[0].start = FIELDS;
+    map[0].length = this->numberOfFields - VMFrameNumberOfRawFields;
+    map[0].count = 1;
+    map[0].stride = 0;
+    //the arguments, locals and the stack up to the stack pointer
+    map[1].start = &FIELDS[this->numberOfFields];
+    map[1].length = this->GetNumberOfLiveFields();
+    map[1].count = 1;
+    map[1].stride = 0;
+    return 2;
 }
@@ -48,10 +48,11 @@ public:
     virtual bool       HasPreviousFrame() const;
     virtual inline bool       IsBootstrapFrame() const;
     virtual inline pVMFrame   GetContext() const;
-    virtual inline void       SetContext(pVMFrame);
+    virtual void       SetContext(pVMFrame);
     virtual bool       HasContext() const;
     virtual pVMFrame   GetContextLevel(int);
-    virtual pVMFrame   GetOuterContext();
+    virtual inline pVMFrame   GetOuterContext();
+    virtual inline pVMObject  GetReceiver() const;
     virtual pVMMethod  GetMethod() const;
     virtual void       SetMethod(pVMMethod);
     virtual pVMObject  Pop();
@@ -70,18 +71,38 @@ public:
     virtual void       CopyArgumentsFrom(pVMFrame frame);
     
     virtual void       MarkReferences();
+    virtual int        GetReferenceMap(ReferenceRange* map) const;
     virtual void       PrintStack() const;
-    virtual inline     pVMInteger GetStackPointer() const;
+    virtual inline     int32_t GetStackPointer() const;
+    virtual inline     void SetStackPointer(int32_t);
+    //the arguments, the locals and the stack up to the stack pointer. The
+    //slots above hold popped objects, which are garbage unless a primitive
+    //running in the frame still uses them.
+    virtual int        GetNumberOfLiveFields() const;
     virtual int        RemainingStackSize() const;
+    virtual int32_t    GetNativeStackOffset() const;
+    virtual void       SetNativeStackOffset(int32_t);
+    //a frame on the native stack is no heap object, so the objects it
+    //refers to are walked as roots; the previous frame is left to the caller
+    virtual void       WalkObjects(RootWalker walk, void* data);
+    virtual pVMObject* GetPreviousFrameSlot();
 private:
     pVMFrame   previousFrame;
     pVMFrame   context;
     pVMMethod  method;
-    pVMInteger stackPointer;
-    pVMInteger bytecodeIndex;
-    pVMInteger localOffset;
+    //the outermost context of a block's frame, and the receiver of the method
+    //the frame or its block belongs to
+    pVMFrame   homeContext;
+    pVMObject  receiver;
+    //raw values, not scanned by the GC
+    int32_t    stackPointer;
+    int32_t    bytecodeIndex;
+    int32_t    localOffset;
+    //top of the interpreter's native frame stack before the frame was pushed
+    int32_t    nativeStackOffset;
 
     static const int VMFrameNumberOfFields;
+    static const int VMFrameNumberOfRawFields;
 };
 
 bool     VMFrame::IsBootstrapFrame() const {
@@ -92,14 +113,22 @@ pVMFrame VMFrame::GetContext() const {
     return this->context;
 }
 
-void     VMFrame::SetContext(pVMFrame frm) {
-    this->context = frm;
+pVMFrame VMFrame::GetOuterContext() {
+    return this->context != nilObject ? this->homeContext : this;
 }
 
-pVMInteger VMFrame::GetStackPointer() const {
+pVMObject VMFrame::GetReceiver() const {
+    return this->receiver;
+}
+
+int32_t VMFrame::GetStackPointer() const {
     return stackPointer;
 }
 
+void VMFrame::SetStackPointer(int32_t sp) {
+    stackPointer = sp;
+}
+
 
 
 pVMFrame VMFrame::GetPreviousFrame() const {
@@ -30,7 +30,6 @@ THE SOFTWARE.
 
 VMFreeObject::VMFreeObject() : VMObject(0) {
     this->gcfield = -1;
-    strcpy(objectType,"VMFreeObject");
 }
 
 void VMFreeObject::SetNext(VMFreeObject* next) {
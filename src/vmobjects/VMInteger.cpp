@@ -31,13 +31,11 @@ const int VMInteger::VMIntegerNumberOfFields = 0;
 
 VMInteger::VMInteger() : VMObject(VMIntegerNumberOfFields) {
     embeddedInteger = 0;
-    strcpy(objectType,"VMInteger");
 }
 
 
 VMInteger::VMInteger(int32_t val) : VMObject(VMIntegerNumberOfFields) {
     embeddedInteger = val;
-    strcpy(objectType,"VMInteger");
 }
 
 
@@ -33,32 +33,43 @@ THE SOFTWARE.
 #include "VMObject.h"
 #include "VMInteger.h"
 #include "Signature.h"
+#include "InlineCache.h"
 
 #include "../vm/Universe.h"
 
 #include "../compiler/MethodGenerationContext.h"
 
 //this method's bytecodes
-#define _BC ((uint8_t*)&FIELDS[this->GetNumberOfFields() + this->GetNumberOfIndexableFields()])
+#define _BC (this->GetBytecodes())
+
+//this method's inline caches, they follow the padded bytecodes
+#define _CACHES ((InlineCache*)(_BC + GetBytecodeSpace(this->bcLength)))
 
 //this method's literals (-> VMArray)
-#define theEntries(i) FIELDS[this->GetNumberOfFields()+i]
-
-const int VMMethod::VMMethodNumberOfFields = 5; 
-
-VMMethod::VMMethod(int bcCount, int numberOfConstants, int nof) 
-                    : VMInvokable(nof + VMMethodNumberOfFields) {
-    _HEAP->StartUninterruptableAllocation();
-    bcLength = _UNIVERSE->NewInteger( bcCount );
-    numberOfLocals = _UNIVERSE->NewInteger(0);
-    maximumNumberOfStackElements = _UNIVERSE->NewInteger(0);
-    numberOfArguments = _UNIVERSE->NewInteger(0);
-    this->numberOfConstants = _UNIVERSE->NewInteger(numberOfConstants);
+#define theEntries(i) FIELDS[this->numberOfFields+i]
+
+//the raw fields are the last ones and take as many pointer sized slots
+//as they need
+const int VMMethod::VMMethodNumberOfRawFields = 
+    (8 * sizeof(int32_t) + sizeof(pVMObject) - 1) / sizeof(pVMObject);
+const int VMMethod::VMMethodNumberOfFields = VMMethodNumberOfRawFields; 
+
+VMMethod::VMMethod(int bcCount, int numberOfConstants, int numberOfSendSites,
+                   int nof) : VMInvokable(nof + VMMethodNumberOfFields) {
+    bcLength = bcCount;
+    numberOfLocals = 0;
+    maximumNumberOfStackElements = 0;
+    numberOfArguments = 0;
+    this->numberOfConstants = numberOfConstants;
+    this->numberOfSendSites = numberOfSendSites;
+    trivialKind = TrivialNone;
+    trivialIndex = 0;
     for (int i = 0; i < numberOfConstants ; ++i) {
         this->SetIndexableField(i, nilObject);
     }
-    strcpy(objectType,"VMMethod");
-    _HEAP->EndUninterruptableAllocation();
+    for (int i = 0; i < numberOfSendSites ; ++i) {
+        _CACHES[i].Initialize();
+    }
 }
 
 void      VMMethod::SetSignature(pVMSymbol sig) { 
@@ -69,49 +80,103 @@ void      VMMethod::SetSignature(pVMSymbol sig) {
 
 void VMMethod::MarkReferences() {
     if (gcfield) return;
-    VMInvokable::MarkReferences();
-    for (int i = 0 ; i < GetNumberOfIndexableFields() ; ++i) {
-		if (theEntries(i) != NULL)
-			theEntries(i)->MarkReferences();
-	}
+    this->SetGCField(1);
+    ReferenceRunIterator runs(this);
+    pVMObject* slots;
+    int length;
+    while (runs.Next(slots, length)) {
+        for (int i = 0; i < length; ++i) {
+            pVMObject o = slots[i];
+            if (o != NULL && !IS_TAGGED(o)) o->MarkReferences();
+        }
+    }
 }
 
-int VMMethod::GetNumberOfLocals() const {
-    return numberOfLocals->GetEmbeddedInteger(); 
+int VMMethod::GetReferenceMap(ReferenceRange* map) const {
+    //the fields up to the raw ones
+    map[0].start = FIELDS;
+    map[0].length = this->numberOfFields - VMMethodNumberOfRawFields;
+    map[0].count = 1;
+    map[0].stride = 0;
+    //the literals
+    map[1].start = &theEntries(0);
+    map[1].length = this->numberOfConstants;
+    map[1].count = 1;
+    map[1].stride = 0;
+    //the classes and invokables of the inline caches, which are followed by
+    //the raw epoch and number of entries of their cache
+    map[2].start = (pVMObject*)_CACHES;
+    map[2].length = 2 * InlineCacheSize;
+    map[2].count = this->numberOfSendSites;
+    map[2].stride = sizeof(InlineCache) / sizeof(pVMObject);
+    return 3;
 }
 
 
-void VMMethod::SetNumberOfLocals(int nol) {
-    numberOfLocals->SetEmbeddedInteger(nol); 
+InlineCache* VMMethod::GetInlineCache(int bytecodeIndex) const {
+    uint8_t site = _BC[bytecodeIndex + 2];
+    if (site == NoInlineCache) return NULL;
+    return &_CACHES[site];
 }
 
 
-int VMMethod::GetMaximumNumberOfStackElements() const {
-    return maximumNumberOfStackElements->GetEmbeddedInteger(); 
+int VMMethod::GetBytecodeSpace(int bcCount) {
+    return (bcCount + sizeof(pVMObject) - 1) & ~(sizeof(pVMObject) - 1);
 }
 
 
-void VMMethod::SetMaximumNumberOfStackElements(int stel) {
-    maximumNumberOfStackElements->SetEmbeddedInteger(stel); 
+void VMMethod::SetNumberOfLocals(int nol) {
+    numberOfLocals = nol;
 }
 
 
-int VMMethod::GetNumberOfArguments() const {
-    return numberOfArguments->GetEmbeddedInteger(); 
+void VMMethod::SetMaximumNumberOfStackElements(int stel) {
+    maximumNumberOfStackElements = stel;
 }
 
 
 void VMMethod::SetNumberOfArguments(int noa) {
-    numberOfArguments->SetEmbeddedInteger(noa); 
-}
-
-
-int VMMethod::GetNumberOfBytecodes() const {
-    return bcLength->GetEmbeddedInteger();
+    numberOfArguments = noa;
+}
+
+
+void VMMethod::SetTrivial(int kind, int index) {
+    trivialKind = kind;
+    trivialIndex = index;
+}
+
+
+bool VMMethod::invokeTrivial(pVMFrame frame) {
+    //the receiver and arguments on the sender's stack are replaced by the
+    //result right away
+    pVMObject self = frame->GetStackElement(numberOfArguments - 1);
+    switch (trivialKind) {
+        case TrivialSelf:
+            for (int i = 1; i < numberOfArguments; ++i) frame->Pop();
+            return true;
+        case TrivialConstant:
+            for (int i = 0; i < numberOfArguments; ++i) frame->Pop();
+            frame->Push(theEntries(trivialIndex));
+            return true;
+        case TrivialGetter:
+            for (int i = 0; i < numberOfArguments; ++i) frame->Pop();
+            //the only field of an integer is its class
+            frame->Push(IS_TAGGED(self) ? (pVMObject)integerClass
+                                        : self->GetField(trivialIndex));
+            return true;
+        case TrivialSetter:
+            if (IS_TAGGED(self)) return false;
+            self->SetField(trivialIndex, frame->Pop());
+            return true;
+        default:
+            return false;
+    }
 }
 
 
 void VMMethod::operator()(pVMFrame frame) {
+    if (trivialKind != TrivialNone && this->invokeTrivial(frame)) return;
+
     pVMFrame frm = _UNIVERSE->GetInterpreter()->PushNewFrame(this);
     frm->CopyArgumentsFrom(frame);
 }
@@ -120,6 +185,7 @@ void VMMethod::operator()(pVMFrame frame) {
 void VMMethod::SetHolderAll(pVMClass hld) {
     for (int i = 0; i < this->GetNumberOfIndexableFields(); ++i) {
         pVMObject o = GetIndexableField(i);
+        if (IS_TAGGED(o)) continue;
         pVMInvokable vmi = dynamic_cast<pVMInvokable>(o);
         if ( vmi != NULL)  {
             vmi->SetHolder(hld);
@@ -128,24 +194,10 @@ void VMMethod::SetHolderAll(pVMClass hld) {
 }
 
 
-pVMObject VMMethod::GetConstant(int indx) const {
-    uint8_t bc = _BC[indx+1];
-    if (bc >= this->GetNumberOfIndexableFields()) {
-        cout << "Error: Constant index out of range" << endl;
-        return NULL;
-    }
-    return this->GetIndexableField(bc);
-}
-
 uint8_t& VMMethod::operator[](int indx) const {
 	return _BC[indx];
 }
 
-uint8_t VMMethod::GetBytecode(int indx) const {
-    return _BC[indx];
-}
-
-
 void VMMethod::SetBytecode(int indx, uint8_t val) {
     _BC[indx] = val;
 }
@@ -156,7 +208,7 @@ pVMArray VMMethod::CopyAndExtendWith(pVMObject item) const {
     size_t fields = this->GetNumberOfIndexableFields();
 	pVMArray result = _UNIVERSE->NewArray(fields+1);
     this->CopyIndexableFieldsTo(result);
-	(*result)[fields] = item;
+	result->SetIndexableField(fields, item);
 	return result;
 }
 
@@ -174,7 +226,7 @@ pVMObject VMMethod::GetIndexableField(int idx) const {
 
 void VMMethod::CopyIndexableFieldsTo(pVMArray to) const {
 	for (int i = 0; i < this->GetNumberOfIndexableFields(); ++i) {
-        (*to)[i] = this->GetIndexableField(i);
+        to->SetIndexableField(i, this->GetIndexableField(i));
 	}
 	
 }
@@ -194,6 +246,6 @@ void VMMethod::SetIndexableField(int idx, pVMObject item) {
 int VMMethod::GetNumberOfIndexableFields() const {
     //cannot be done using GetAdditionalSpaceConsumption,
     //as bytecodes need space, too, and there might be padding
-    return this->numberOfConstants->GetEmbeddedInteger();
+    return this->numberOfConstants;
 }
 
@@ -37,25 +37,48 @@ class VMObject;
 class VMInteger;
 class MethodGenerationContext;
 class VMFrame;
+class InlineCache;
+
+// The kinds of trivial methods, which the compiler recognizes and a send runs
+// without a frame of their own. The index is that of the literal answered or
+// of the field read or written.
+#define TrivialNone      0
+#define TrivialSelf      1  // ^self
+#define TrivialConstant  2  // ^literal
+#define TrivialGetter    3  // ^field
+#define TrivialSetter    4  // field := argument, answers self
 
 class VMMethod :  public VMInvokable {
 
 public:
-	VMMethod(int bcCount, int numberOfConstants, int nof = 0);
+	VMMethod(int bcCount, int numberOfConstants, int numberOfSendSites = 0,
+             int nof = 0);
    
-    virtual int       GetNumberOfLocals() const;
+    inline  int       GetNumberOfLocals() const;
     virtual void      SetNumberOfLocals(int nol);
-    virtual int       GetMaximumNumberOfStackElements() const;
+    inline  int       GetMaximumNumberOfStackElements() const;
     virtual void      SetMaximumNumberOfStackElements(int stel);
-    virtual int       GetNumberOfArguments() const;
+    inline  int       GetNumberOfArguments() const;
     virtual void      SetNumberOfArguments(int);
-    virtual int       GetNumberOfBytecodes() const;
+    inline  int       GetNumberOfBytecodes() const;
     virtual void      SetHolderAll(pVMClass hld); 
-    virtual pVMObject GetConstant(int indx) const; 
-    virtual uint8_t   GetBytecode(int indx) const; 
+    inline  pVMObject GetConstant(int indx) const; 
+    inline  pVMObject GetLiteral(int indx) const;
+    inline  uint8_t   GetBytecode(int indx) const; 
     virtual void      SetBytecode(int indx, uint8_t); 
+    inline  uint8_t*  GetBytecodes() const;
 	virtual void      MarkReferences();
     virtual int       GetNumberOfIndexableFields() const;
+    virtual int       GetReferenceMap(ReferenceRange* map) const;
+    inline  int       GetNumberOfSendSites() const;
+    InlineCache*      GetInlineCache(int bytecodeIndex) const;
+    inline  int       GetTrivialKind() const;
+    inline  int       GetTrivialIndex() const;
+    virtual void      SetTrivial(int kind, int index);
+
+    // space needed for the bytecodes, padded so the inline caches
+    // behind them are pointer aligned
+    static int        GetBytecodeSpace(int bcCount);
 
     void              SetIndexableField(int idx, pVMObject item);
 
@@ -81,15 +104,67 @@ public:
 
 private:
     pVMObject   GetIndexableField(int idx) const;
-
-    pVMInteger numberOfLocals;
-    pVMInteger maximumNumberOfStackElements;
-    pVMInteger bcLength;
-    pVMInteger numberOfArguments;
-    pVMInteger numberOfConstants;
+    bool        invokeTrivial(pVMFrame frame);
+
+    //raw values, not scanned by the GC
+    int32_t numberOfLocals;
+    int32_t maximumNumberOfStackElements;
+    int32_t bcLength;
+    int32_t numberOfArguments;
+    int32_t numberOfConstants;
+    int32_t numberOfSendSites;
+    int32_t trivialKind;
+    int32_t trivialIndex;
 
     static const int VMMethodNumberOfFields;
+    static const int VMMethodNumberOfRawFields;
 };
 
+int VMMethod::GetNumberOfLocals() const {
+    return numberOfLocals;
+}
+
+int VMMethod::GetMaximumNumberOfStackElements() const {
+    return maximumNumberOfStackElements;
+}
+
+int VMMethod::GetNumberOfArguments() const {
+    return numberOfArguments;
+}
+
+int VMMethod::GetNumberOfBytecodes() const {
+    return bcLength;
+}
+
+int VMMethod::GetNumberOfSendSites() const {
+    return numberOfSendSites;
+}
+
+int VMMethod::GetTrivialKind() const {
+    return trivialKind;
+}
+
+int VMMethod::GetTrivialIndex() const {
+    return trivialIndex;
+}
+
+uint8_t* VMMethod::GetBytecodes() const {
+    //the bytecodes follow the literals
+    return (uint8_t*)&FIELDS[numberOfFields + numberOfConstants];
+}
+
+uint8_t VMMethod::GetBytecode(int indx) const {
+    return GetBytecodes()[indx];
+}
+
+pVMObject VMMethod::GetConstant(int indx) const {
+    //the literal index is the operand of the bytecode at indx
+    return FIELDS[numberOfFields + GetBytecodes()[indx + 1]];
+}
+
+pVMObject VMMethod::GetLiteral(int indx) const {
+    return FIELDS[numberOfFields + indx];
+}
+
 
 #endif
@@ -35,6 +35,7 @@ THE SOFTWARE.
 
 //clazz is the only field of VMObject so
 const int VMObject::VMObjectNumberOfFields = 1; 
+uint32_t VMObject::nextHash = 0;
 
 VMObject::VMObject( int numberOfFields ) {
     //this line would be needed if the VMObject** is used instead of the macro:
@@ -44,27 +45,14 @@ VMObject::VMObject( int numberOfFields ) {
 	//
 	this->SetNumberOfFields(numberOfFields + VMObjectNumberOfFields);
     gcfield = 0; 
-	hash = (int32_t)this;
+	//the address would change when the GC compacts the heap, and may be
+	//reused by another object later on
+	hash = (int32_t)(nextHash++ & 0x7fffffff);
 	this->SetClass(NULL);
-	memset(objectType,0,OTLEN);
-	strcpy(objectType,"VMObject");
 	reserved_align  = 0;
-	addToObjectTable();
     //Object size is set by the heap
 }
 
-void VMObject::addToObjectTable(){
-	//
-
-	   char * name =(char *)malloc(20);
-	   memset(name,0,20);
-	  sprintf(name,"%9s%p",objectType,hash);
-	    ObjectEntry oEntry = {name,(omrobjectptr_t)this,0};
-		ObjectEntry *entryInTable = (ObjectEntry *)hashTableAdd(Heap::GetHeap()->getVM()->objectTable, &oEntry);
-		/* update entry if it already exists in table */
-		entryInTable->objPtr = (omrobjectptr_t)this;
-}
-
 void VMObject::SetNumberOfFields(int nof) {
     this->numberOfFields = nof;
 
@@ -76,16 +64,21 @@ void VMObject::SetNumberOfFields(int nof) {
 
 
 
-void VMObject::Send(StdString selectorString, pVMObject* arguments, int argc) {
+// static, as the receiver might be a tagged integer
+void VMObject::Send(pVMObject receiver, const StdString& selectorString,
+                    pVMObject* arguments, int argc) {
+    //the pushes may overwrite the arguments a primitive popped, a bytecode
+    //sending from C++ can't be restarted
+    Heap::PreventRetry();
     pVMSymbol selector = _UNIVERSE->SymbolFor(selectorString);
     pVMFrame frame = _UNIVERSE->GetInterpreter()->GetFrame();
-    frame->Push(this);
+    frame->Push(receiver);
 
     for(int i = 0; i < argc; ++i) {
         frame->Push(arguments[i]);
     }
 
-    pVMClass cl = this->GetClass();
+    pVMClass cl = CLASS_OF(receiver);
     pVMInvokable invokable = (pVMInvokable)(cl->LookupInvokable(selector));
     (*invokable)(frame);
 }
@@ -186,24 +179,21 @@ int VMObject::GetAdditionalSpaceConsumption() const
     return rt;
 }
 
- pVMObject       VMObject::GetMarkableFieldObj(int idx) const {
-	 int fn = GetNumberOfFields();
-	 int in = GetNumberOfIndexableFields();
-	 if(idx <fn ){
-		 return (pVMObject) FIELDS[idx];
-	 }else if (idx<fn+in){
-		 return (pVMObject)*(GetStartOfAdditionalPoint()+(idx-fn));
-	 }else {
-		 return NULL;
-	 }
- }
+int VMObject::GetReferenceMap(ReferenceRange* map) const {
+    //the indexable fields, if any, follow the fields
+    map[0].start = FIELDS;
+    map[0].length = this->numberOfFields + this->GetNumberOfIndexableFields();
+    map[0].count = 1;
+    map[0].stride = 0;
+    return 1;
+}
 
 void VMObject::MarkReferences() {
     if (this->gcfield) return;
 	this->SetGCField(1);
     for( int i = 0; i < this->GetNumberOfFields(); ++i) {
         pVMObject o = (FIELDS[i]);
-        o->MarkReferences();
+        if (!IS_TAGGED(o)) o->MarkReferences();
     }
 
 }
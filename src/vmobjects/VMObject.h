@@ -44,7 +44,20 @@ class VMSymbol;
 class VMClass;
 
 #define FIELDS ((pVMObject*)&clazz)
-#define OTLEN 16
+
+//The reference map of an object tells the GC where its references are: in a
+//few runs of contiguous slots, so that scanning an object takes one call to
+//it and none per slot. Raw values such as bytecodes, characters or embedded
+//numbers lie outside of the runs. A range is count runs of length slots,
+//stride slots apart, as the inline caches of a method are.
+#define MAX_REFERENCE_RANGES 3
+
+struct ReferenceRange {
+    pVMObject* start;
+    int        length;
+    int        count;
+    int        stride;
+};
 /*
  **************************VMOBJECT****************************
  * __________________________________________________________ *
@@ -77,16 +90,15 @@ public:
 	virtual int         GetFieldIndex(pVMSymbol fieldName) const;
 	//zg.add start
 	virtual int       GetNumberOfIndexableFields() const {return 0;};
-	virtual int       GetNumberOfMarkableFields() const {return GetNumberOfFields()+GetNumberOfIndexableFields();};
-	virtual pVMObject       GetMarkableFieldObj(int idx) const ;
+	//fills in at most MAX_REFERENCE_RANGES ranges, returns their number
+	virtual int       GetReferenceMap(ReferenceRange* map) const;
 	//This impl may not workable for some class (such as VMInteger, but it only make sense for the class which has at lease one indexableFields. We can only focus on the VMARray and VMMethods
 	virtual pVMObject * GetStartOfAdditionalPoint() const{ return &(FIELDS[this->GetNumberOfFields()]);};
-   virtual void addToObjectTable();
 	//zg.add end.
 	virtual int         GetNumberOfFields() const;
 	virtual void        SetNumberOfFields(int nof);
 	virtual int         GetDefaultNumberOfFields() const;
-	virtual void        Send(StdString, pVMObject*, int);
+	static  void        Send(pVMObject, const StdString&, pVMObject*, int);
 	virtual pVMObject   GetField(int index) const;
     virtual void        Assert(bool value) const;
 	virtual void        SetField(int index, pVMObject value);
@@ -94,8 +106,6 @@ public:
 
     virtual void        IncreaseGCCount() {};
     virtual void        DecreaseGCCount() {};
-    //virtual void setObjectType(const char * ot) {strncpy(objectType,ot,OTLEN-1); objectType[OTLEN-1]=0;}
-     char * getObjectType() const {return (char *)objectType;}
     int32_t     GetHash() const { return hash; };
     int32_t     GetObjectSize() const;
 	int32_t     GetGCField() const;
@@ -137,7 +147,6 @@ protected:
     int32_t     objectSize; //set by the heap at allocation time
     int32_t     numberOfFields;
     int32_t     gcfield;
-    char objectType[OTLEN];
 
     //pVMObject* FIELDS;
     //Start of fields. All members beyond this point are indexable 
@@ -146,6 +155,42 @@ protected:
 	pVMClass    clazz;
 private:
     static const int VMObjectNumberOfFields;
+    //source of the identity hashes, see the constructor
+    static uint32_t nextHash;
+};
+
+
+//Iterates the reference slots of an object run by run, see GetReferenceMap
+class ReferenceRunIterator {
+public:
+    ReferenceRunIterator(const VMObject* object) : range(0), run(0) {
+        numberOfRanges = object->GetReferenceMap(map);
+    }
+
+    //sets start and length to the next run of slots, false if none is left
+    inline bool Next(pVMObject*& start, int& length) {
+        while (range < numberOfRanges) {
+            const ReferenceRange& r = map[range];
+            if (run < r.count && r.length > 0) {
+                start = r.start + run * r.stride;
+                length = r.length;
+                if (++run == r.count) {
+                    ++range;
+                    run = 0;
+                }
+                return true;
+            }
+            ++range;
+            run = 0;
+        }
+        return false;
+    }
+
+private:
+    ReferenceRange map[MAX_REFERENCE_RANGES];
+    int numberOfRanges;
+    int range;
+    int run;
 };
 
 
@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include "VMPrimitive.h"
 #include "VMSymbol.h"
+#include "VMFrame.h"
 #include "VMClass.h"
 
 #include "../vm/Universe.h"
@@ -53,12 +54,38 @@ VMPrimitive::VMPrimitive(pVMSymbol signature) : VMInvokable(VMPrimitiveNumberOfF
     this->SetSignature(signature);
     this->routine = NULL;
     this->empty = false;
-    strcpy(objectType,"VMPrim");
     _HEAP->EndUninterruptableAllocation();
 }
 
-int       VMPrimitive::GetNumberOfMarkableFields() const
-{return GetNumberOfFields()- VMPrimitiveNumberOfFields;}
+void VMPrimitive::operator()(pVMFrame frm) {
+    //the GC scans frames up to their stack pointer only, but the routine may
+    //still use the arguments it popped. Primitives nest when one sends a
+    //message.
+    Interpreter* interpreter = _UNIVERSE->GetInterpreter();
+    pVMFrame outerFrame = interpreter->GetPrimitiveFrame();
+    int32_t outerStackPointer = interpreter->GetPrimitiveStackPointer();
+    int32_t stackPointer = frm->GetStackPointer();
+    interpreter->SetPrimitiveFrame(frm, stackPointer);
+    try {
+        (*routine)(this, frm);
+    } catch (Heap::AllocationRetry&) {
+        //the bytecode sending the message runs again, with the arguments the
+        //routine popped
+        frm->SetStackPointer(stackPointer);
+        interpreter->SetPrimitiveFrame(outerFrame, outerStackPointer);
+        throw;
+    }
+    interpreter->SetPrimitiveFrame(outerFrame, outerStackPointer);
+}
+
+int VMPrimitive::GetReferenceMap(ReferenceRange* map) const {
+    //the routine and the empty flag are no references
+    map[0].start = FIELDS;
+    map[0].length = this->numberOfFields - VMPrimitiveNumberOfFields;
+    map[0].count = 1;
+    map[0].stride = 0;
+    return 1;
+}
 
 void VMPrimitive::MarkReferences() {
     if (gcfield) return;
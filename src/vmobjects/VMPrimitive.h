@@ -44,13 +44,13 @@ public:
     
     virtual inline bool    IsEmpty() const;
     virtual inline void    SetRoutine(PrimitiveRoutine* rtn);
-    virtual int       GetNumberOfMarkableFields() const;
+    virtual int       GetReferenceMap(ReferenceRange* map) const;
     virtual void    MarkReferences();
     virtual void    SetEmpty(bool value) { empty = value; };
 
     //-----------VMInvokable-------//
     //operator "()" to invoke the primitive
-    virtual void    operator()(pVMFrame frm) { (*routine)(this, frm); };
+    virtual void    operator()(pVMFrame frm);
 
     virtual bool      IsPrimitive() const { return true; };
     
@@ -37,8 +37,9 @@ THE SOFTWARE.
 const int VMString::VMStringNumberOfFields = 0; 
 
 VMString::VMString(const char* str) : VMObject(VMStringNumberOfFields) {
-	//set the chars-pointer to point at the position of the first character
-    chars = (char*)&chars+sizeof(char*);
+	//the characters start right behind the offset
+    charsOffset = (char*)&charsOffset + sizeof(intptr_t) - (char*)this;
+    char* chars = GetChars();
 	
     size_t i = 0;
 	for (; i < strlen(str); ++i) {
@@ -46,31 +47,37 @@ VMString::VMString(const char* str) : VMObject(VMStringNumberOfFields) {
 	}
 	chars[i] = '\0';
 	
-	strcpy(objectType,"VMString");
+}
+
+
+VMString::VMString( const char* str, size_t length, char* location )
+                  : VMObject(VMStringNumberOfFields) {
+    charsOffset = location - (char*)this;
+    char* chars = GetChars();
+    memcpy(chars, str, length);
+    chars[length] = '\0';
 }
 
 
 VMString::VMString( const StdString& s ): VMObject(VMStringNumberOfFields) {
-    //set the chars-pointer to point at the position of the first character
-	chars = (char*)&chars+sizeof(char*);
+    //the characters start right behind the offset
+    charsOffset = (char*)&charsOffset + sizeof(intptr_t) - (char*)this;
+    char* chars = GetChars();
 	size_t i = 0;
 	for (; i < s.length(); ++i) {
 		chars[i] = s[i];
 	}
 	chars[i] = '\0';
-	strcpy(objectType,"VMPrim");
 } 
 
 int VMString::GetStringLength() const {
-    //get the additional memory allocated by this object and substract one
-    //for the '0' character and four for the char*
-    return this->GetAdditionalSpaceConsumption() - 4 - 1;
+    //the characters take up the rest of the object, minus one for the '\0'
+    return this->objectSize - this->charsOffset - 1;
 }
 
 
 StdString VMString::GetStdString() const {
-    if (chars == 0) return StdString("");
-	return StdString(chars);
+	return StdString(GetChars());
 }
 
 
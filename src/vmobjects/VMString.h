@@ -42,15 +42,19 @@ public:
 
     
 protected:
-    //this could be replaced by the CHARS macro in VMString.cpp
-    //in order to decrease the object size
-	char* chars; 
+    //for subclasses with fields of their own, which store the characters
+    //behind those
+    VMString( const char* str, size_t length, char* location );
+
+    //where the characters start, relative to the object: unlike their
+    //address it stays valid when the GC moves the string
+	intptr_t charsOffset; 
 
 private:
     static const int VMStringNumberOfFields;
 };
 
 char* VMString::GetChars() const {
-	return chars;
+	return (char*)this + charsOffset;
 }
 #endif
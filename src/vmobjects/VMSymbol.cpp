@@ -31,13 +31,49 @@ THE SOFTWARE.
 #include "VMInteger.h"
 
 
-VMSymbol::VMSymbol(const char* str) : VMString(str) {
-	strcpy(objectType,"VMSymbol");
+VMSymbol::VMSymbol(const char* str, size_t length)
+                  : VMString(str, length, (char*)(this + 1)) {
+    stringHash = HashChars(str, length);
+
+    //symbols are interned once, so their selector properties are computed
+    //here rather than on every send
+    switch (str[0]) {
+        case '~' :
+        case '&' :
+        case '|' :
+        case '*' :
+        case '/' :
+        case '@' :
+        case '+' :
+        case '-' :
+        case '=' :
+        case '>' :
+        case '<' :
+        case ',' :
+        case '%' :
+        case '\\':
+            binary = true;
+            numberOfArguments = 2;
+            return;
+        default:
+            binary = false;
+    }
+
+    //the number of arguments is the number of colons plus one for self
+    numberOfArguments = 1;
+    for (size_t i = 0; i < length; ++i)
+        if (str[i] == ':') numberOfArguments++;
 }
 
 
-VMSymbol::VMSymbol( const StdString& s ): VMString(s) {
-	strcpy(objectType,"VMSymbol");
+uint32_t VMSymbol::HashChars(const char* chars, size_t length) {
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)chars[i];
+        hash *= 16777619u;
+    }
+    return hash;
 }
 
 
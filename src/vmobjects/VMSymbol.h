@@ -39,10 +39,21 @@ class VMInteger;
 class VMSymbol : public VMString {
 
 public:
-	VMSymbol( const char* str );
-	VMSymbol( const StdString& s );
+	VMSymbol( const char* str, size_t length );
     virtual StdString GetPlainString() const;
 
+    //the arity of the symbol as a selector, including the receiver
+    int       GetNumberOfArguments() const { return numberOfArguments; };
+    bool      IsBinary() const { return binary; };
+
+    //the hash of the characters, which the symbol table is organized by
+    uint32_t  GetStringHash() const { return stringHash; };
+    static uint32_t HashChars(const char* chars, size_t length);
+
+private:
+    uint32_t  stringHash;
+    int32_t   numberOfArguments;
+    bool      binary;
 };
 
 